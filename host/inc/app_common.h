@@ -14,25 +14,17 @@
  * limitations under the License.
  */
 
-#include "messages/message_bye.h"
+#ifndef HOST_APP_COMMON_H_
+#define HOST_APP_COMMON_H_
 
-void message_bye_init(message_bye_t *message)
-{
-	message_base_init(&message->base);
-	message_set_type(&message->base, MESSAGE_BYE);
-}
-
-void message_bye_destroy(message_bye_t *message)
-{
-	message_base_destroy(&message->base);
-}
+/*
+ * Host replacement of Tizen <app_common.h>.
+ */
 
-int message_bye_deserialize(message_bye_t *message, reader_t *reader)
-{
-	return message_base_deserialize(&message->base, reader);
-}
+/**
+ * @brief Returns newly allocated data directory path ending with '/'.
+ * @remarks Taken from CAR_APP_DATA_PATH environment variable, "/tmp/" otherwise.
+ */
+char *app_get_data_path(void);
 
-int message_bye_serialize(message_bye_t *message, writer_t *writer)
-{
-	return message_base_serialize(&message->base, writer);
-}
+#endif /* HOST_APP_COMMON_H_ */
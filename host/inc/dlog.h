@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOST_DLOG_H_
+#define HOST_DLOG_H_
+
+/*
+ * Host replacement of Tizen <dlog.h>, messages go to stderr.
+ */
+
+#include <stdarg.h>
+#include <errno.h>
+
+typedef enum {
+	DLOG_UNKNOWN = 0,
+	DLOG_DEFAULT,
+	DLOG_VERBOSE,
+	DLOG_DEBUG,
+	DLOG_INFO,
+	DLOG_WARN,
+	DLOG_ERROR,
+	DLOG_FATAL,
+	DLOG_SILENT,
+	DLOG_PRIO_MAX,
+} log_priority;
+
+int dlog_print(log_priority prio, const char *tag, const char *fmt, ...);
+int dlog_vprint(log_priority prio, const char *tag, const char *fmt, va_list ap);
+
+/**
+ * @brief Messages below @a prio are discarded, DLOG_INFO by default.
+ * @remarks Host only, lets benchmarks keep debug logging out of timed paths.
+ */
+void dlog_set_min_priority(log_priority prio);
+
+#endif /* HOST_DLOG_H_ */
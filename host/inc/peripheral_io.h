@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOST_PERIPHERAL_IO_H_
+#define HOST_PERIPHERAL_IO_H_
+
+/*
+ * Host replacement of Tizen <peripheral_io.h>.
+ *
+ * Declares the subset of the Peripheral I/O API used by resource drivers.
+ * Calls are served by the simulator in host/src/peripheral_sim.c,
+ * see peripheral_sim.h for the simulator control interface.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+
+typedef enum {
+	PERIPHERAL_ERROR_NONE = 0,
+	PERIPHERAL_ERROR_IO_ERROR = -EIO,
+	PERIPHERAL_ERROR_NO_DEVICE = -ENODEV,
+	PERIPHERAL_ERROR_TRY_AGAIN = -EAGAIN,
+	PERIPHERAL_ERROR_OUT_OF_MEMORY = -ENOMEM,
+	PERIPHERAL_ERROR_PERMISSION_DENIED = -EACCES,
+	PERIPHERAL_ERROR_RESOURCE_BUSY = -EBUSY,
+	PERIPHERAL_ERROR_INVALID_PARAMETER = -EINVAL,
+	PERIPHERAL_ERROR_INVALID_OPERATION = -ENOSYS,
+} peripheral_error_e;
+
+typedef struct _peripheral_gpio_s *peripheral_gpio_h;
+typedef struct _peripheral_i2c_s *peripheral_i2c_h;
+
+typedef enum {
+	PERIPHERAL_GPIO_DIRECTION_IN = 0,
+	PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_HIGH,
+	PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_LOW,
+} peripheral_gpio_direction_e;
+
+typedef enum {
+	PERIPHERAL_GPIO_EDGE_NONE = 0,
+	PERIPHERAL_GPIO_EDGE_RISING,
+	PERIPHERAL_GPIO_EDGE_FALLING,
+	PERIPHERAL_GPIO_EDGE_BOTH,
+} peripheral_gpio_edge_e;
+
+typedef void (*peripheral_gpio_interrupted_cb)(peripheral_gpio_h gpio, peripheral_error_e error, void *user_data);
+
+int peripheral_gpio_open(int gpio_pin, peripheral_gpio_h *gpio);
+int peripheral_gpio_close(peripheral_gpio_h gpio);
+int peripheral_gpio_set_direction(peripheral_gpio_h gpio, peripheral_gpio_direction_e direction);
+int peripheral_gpio_set_edge_mode(peripheral_gpio_h gpio, peripheral_gpio_edge_e edge);
+int peripheral_gpio_set_interrupted_cb(peripheral_gpio_h gpio, peripheral_gpio_interrupted_cb callback, void *user_data);
+int peripheral_gpio_unset_interrupted_cb(peripheral_gpio_h gpio);
+int peripheral_gpio_read(peripheral_gpio_h gpio, uint32_t *value);
+int peripheral_gpio_write(peripheral_gpio_h gpio, uint32_t value);
+
+int peripheral_i2c_open(int bus, int address, peripheral_i2c_h *i2c);
+int peripheral_i2c_close(peripheral_i2c_h i2c);
+int peripheral_i2c_read(peripheral_i2c_h i2c, uint8_t *data, uint32_t length);
+int peripheral_i2c_write(peripheral_i2c_h i2c, uint8_t *data, uint32_t length);
+int peripheral_i2c_read_register_byte(peripheral_i2c_h i2c, uint8_t reg, uint8_t *data);
+int peripheral_i2c_write_register_byte(peripheral_i2c_h i2c, uint8_t reg, uint8_t data);
+
+#endif /* HOST_PERIPHERAL_IO_H_ */
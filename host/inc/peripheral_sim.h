@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOST_PERIPHERAL_SIM_H_
+#define HOST_PERIPHERAL_SIM_H_
+
+#include <stdint.h>
+
+/*
+ * Control interface of the host peripheral simulator.
+ *
+ * The simulator implements <peripheral_io.h> with:
+ *  - a PCA9685 register file at bus 1, address 0x40 (MODE1 auto-increment,
+ *    ALL_LED broadcast and SLEEP-gated PRE_SCALE are modelled),
+ *  - PERIPHERAL_SIM_GPIO_MAX GPIO pins with direction, edge mode and
+ *    interrupt callbacks,
+ *  - configurable busy-wait latency per transaction, so timings reflect
+ *    number and size of bus transfers,
+ *  - transaction counters and fault injection.
+ *
+ * All functions are thread safe. Interrupt callbacks are called
+ * synchronously from peripheral_sim_gpio_inject().
+ */
+
+#define PERIPHERAL_SIM_GPIO_MAX 64
+#define PERIPHERAL_SIM_PCA9685_BUS 1
+#define PERIPHERAL_SIM_PCA9685_ADDRESS 0x40
+#define PERIPHERAL_SIM_PCA9685_CHANNELS 16
+
+/**
+ * @brief Simulated bus timings, all zero by default.
+ */
+typedef struct peripheral_sim_latency {
+	unsigned int i2c_transaction_us; /** Fixed cost of every I2C transaction (start, address, stop). */
+	unsigned int i2c_byte_us;        /** Cost of every byte transferred, ~90us at 100kHz. */
+	unsigned int gpio_us;            /** Cost of every GPIO read or write. */
+} peripheral_sim_latency_s;
+
+/**
+ * @brief Simulator counters.
+ */
+typedef struct peripheral_sim_stats {
+	unsigned long long i2c_transactions;
+	unsigned long long i2c_bytes;
+	unsigned long long gpio_reads;
+	unsigned long long gpio_writes;
+	unsigned long long interrupts;
+	unsigned long long faults; /** Operations failed on purpose, see peripheral_sim_fail_next. */
+} peripheral_sim_stats_s;
+
+/**
+ * @brief Restores power-on state of all devices and clears counters.
+ * @remarks Open handles stay valid. Drivers must be re-initialized,
+ * e.g. PCA9685 loses MODE1 auto-increment bit.
+ */
+void peripheral_sim_reset(void);
+
+/**
+ * @brief Clears counters only, device state is kept.
+ */
+void peripheral_sim_reset_stats(void);
+
+/**
+ * @param[in] latency Timings applied to subsequent transactions.
+ */
+void peripheral_sim_set_latency(const peripheral_sim_latency_s *latency);
+
+/**
+ * @param[out] stats Current counters.
+ */
+void peripheral_sim_get_stats(peripheral_sim_stats_s *stats);
+
+/**
+ * @brief Makes next @a count I2C or GPIO operations fail with PERIPHERAL_ERROR_IO_ERROR.
+ */
+void peripheral_sim_fail_next(unsigned int count);
+
+/**
+ * @brief Reads PCA9685 register without bus latency or counting.
+ */
+uint8_t peripheral_sim_pca9685_get_register(uint8_t reg);
+
+/**
+ * @brief Reads 12-bit ON and OFF counts of PCA9685 channel.
+ * @return 0 on success, -1 if channel is out of range.
+ */
+int peripheral_sim_pca9685_get_channel(unsigned int channel, unsigned int *on, unsigned int *off);
+
+/**
+ * @brief Overwrites 12-bit ON and OFF counts of PCA9685 channel without
+ * bus latency or counting, e.g. to emulate a glitch the driver did not see.
+ * @return 0 on success, -1 if channel is out of range.
+ */
+int peripheral_sim_pca9685_set_channel(unsigned int channel, unsigned int on, unsigned int off);
+
+/**
+ * @brief Reads current level of GPIO pin.
+ * @return 0 on success, -1 if pin is out of range.
+ */
+int peripheral_sim_gpio_get_value(int pin, uint32_t *value);
+
+/**
+ * @brief Drives input GPIO pin from outside, e.g. IR sensor output.
+ * @remarks Calls interrupt callback when level change matches edge mode.
+ * @return 0 on success, -1 if pin is out of range or not an input.
+ */
+int peripheral_sim_gpio_inject(int pin, uint32_t value);
+
+#endif /* HOST_PERIPHERAL_SIM_H_ */
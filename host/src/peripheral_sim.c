@@ -0,0 +1,572 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <peripheral_io.h>
+#include "peripheral_sim.h"
+
+#define PCA9685_REG_COUNT 256
+#define PCA9685_MODE1 0x00
+#define PCA9685_MODE2 0x01
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_ALL_LED_ON_L 0xFA
+#define PCA9685_PRESCALE 0xFE
+#define PCA9685_MODE1_RESTART 0x80
+#define PCA9685_MODE1_AI 0x20
+#define PCA9685_MODE1_SLEEP 0x10
+#define PCA9685_MODE1_ALLCALL 0x01
+#define PCA9685_MODE2_OUTDRV 0x04
+#define PCA9685_PRESCALE_DEFAULT 0x1E
+#define PCA9685_CHANNEL_REG_COUNT 4
+
+struct _peripheral_gpio_s {
+	int pin;
+};
+
+struct _peripheral_i2c_s {
+	int bus;
+	int address;
+};
+
+typedef struct _sim_gpio_pin_s {
+	bool opened;
+	peripheral_gpio_direction_e direction;
+	peripheral_gpio_edge_e edge;
+	uint32_t value;
+	peripheral_gpio_interrupted_cb cb;
+	void *cb_data;
+	struct _peripheral_gpio_s handle;
+} sim_gpio_pin_s;
+
+static struct {
+	pthread_mutex_t lock;
+	peripheral_sim_latency_s latency;
+	peripheral_sim_stats_s stats;
+	unsigned int fail_count;
+	uint8_t pca9685[PCA9685_REG_COUNT];
+	uint8_t pca9685_pointer;
+	sim_gpio_pin_s pins[PERIPHERAL_SIM_GPIO_MAX];
+} s_sim = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.pca9685 = {
+		[PCA9685_MODE1] = PCA9685_MODE1_SLEEP | PCA9685_MODE1_ALLCALL,
+		[PCA9685_MODE2] = PCA9685_MODE2_OUTDRV,
+		[PCA9685_PRESCALE] = PCA9685_PRESCALE_DEFAULT,
+	},
+};
+
+static void __busy_wait_us(unsigned int us)
+{
+	struct timespec start, now;
+	long long elapsed_ns;
+
+	if (us == 0)
+		return;
+
+	/* nanosleep granularity is too coarse for bus timings */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		elapsed_ns = (now.tv_sec - start.tv_sec) * 1000000000LL
+			+ (now.tv_nsec - start.tv_nsec);
+	} while (elapsed_ns < us * 1000LL);
+}
+
+/* called with lock held */
+static bool __fault(void)
+{
+	if (s_sim.fail_count == 0)
+		return false;
+
+	s_sim.fail_count--;
+	s_sim.stats.faults++;
+	return true;
+}
+
+/* called with lock held */
+static void __i2c_transaction(uint32_t bytes)
+{
+	s_sim.stats.i2c_transactions++;
+	s_sim.stats.i2c_bytes += bytes;
+	__busy_wait_us(s_sim.latency.i2c_transaction_us + bytes * s_sim.latency.i2c_byte_us);
+}
+
+static void __pca9685_power_on(void)
+{
+	memset(s_sim.pca9685, 0, sizeof(s_sim.pca9685));
+	s_sim.pca9685[PCA9685_MODE1] = PCA9685_MODE1_SLEEP | PCA9685_MODE1_ALLCALL;
+	s_sim.pca9685[PCA9685_MODE2] = PCA9685_MODE2_OUTDRV;
+	s_sim.pca9685[PCA9685_PRESCALE] = PCA9685_PRESCALE_DEFAULT;
+	s_sim.pca9685_pointer = 0;
+}
+
+/* called with lock held */
+static void __pca9685_store(uint8_t reg, uint8_t value)
+{
+	int ch;
+
+	if (reg == PCA9685_MODE1) {
+		/* restart completes immediately */
+		s_sim.pca9685[reg] = value & ~PCA9685_MODE1_RESTART;
+		return;
+	}
+
+	if (reg == PCA9685_PRESCALE) {
+		/* PRE_SCALE can only be set while oscillator is off */
+		if (s_sim.pca9685[PCA9685_MODE1] & PCA9685_MODE1_SLEEP)
+			s_sim.pca9685[reg] = value;
+		return;
+	}
+
+	s_sim.pca9685[reg] = value;
+
+	if (reg >= PCA9685_ALL_LED_ON_L && reg < PCA9685_ALL_LED_ON_L + PCA9685_CHANNEL_REG_COUNT) {
+		for (ch = 0; ch < PERIPHERAL_SIM_PCA9685_CHANNELS; ch++)
+			s_sim.pca9685[PCA9685_LED0_ON_L + ch * PCA9685_CHANNEL_REG_COUNT
+				+ (reg - PCA9685_ALL_LED_ON_L)] = value;
+	}
+}
+
+/* called with lock held */
+static void __pca9685_advance_pointer(void)
+{
+	if (s_sim.pca9685[PCA9685_MODE1] & PCA9685_MODE1_AI)
+		s_sim.pca9685_pointer++;
+}
+
+static bool __i2c_handle_valid(peripheral_i2c_h i2c)
+{
+	return i2c && i2c->bus == PERIPHERAL_SIM_PCA9685_BUS
+		&& i2c->address == PERIPHERAL_SIM_PCA9685_ADDRESS;
+}
+
+int peripheral_i2c_open(int bus, int address, peripheral_i2c_h *i2c)
+{
+	peripheral_i2c_h handle;
+
+	if (!i2c)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	if (bus != PERIPHERAL_SIM_PCA9685_BUS || address != PERIPHERAL_SIM_PCA9685_ADDRESS)
+		return PERIPHERAL_ERROR_NO_DEVICE;
+
+	handle = malloc(sizeof(*handle));
+	if (!handle)
+		return PERIPHERAL_ERROR_OUT_OF_MEMORY;
+
+	handle->bus = bus;
+	handle->address = address;
+	*i2c = handle;
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_i2c_close(peripheral_i2c_h i2c)
+{
+	if (!i2c)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	free(i2c);
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_i2c_write(peripheral_i2c_h i2c, uint8_t *data, uint32_t length)
+{
+	uint32_t i;
+
+	if (!__i2c_handle_valid(i2c) || !data || length == 0)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	__i2c_transaction(length);
+	if (__fault()) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_IO_ERROR;
+	}
+
+	/* first byte sets register pointer, the rest is stored from there */
+	s_sim.pca9685_pointer = data[0];
+	for (i = 1; i < length; i++) {
+		__pca9685_store(s_sim.pca9685_pointer, data[i]);
+		__pca9685_advance_pointer();
+	}
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_i2c_read(peripheral_i2c_h i2c, uint8_t *data, uint32_t length)
+{
+	uint32_t i;
+
+	if (!__i2c_handle_valid(i2c) || !data || length == 0)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	__i2c_transaction(length);
+	if (__fault()) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_IO_ERROR;
+	}
+
+	for (i = 0; i < length; i++) {
+		data[i] = s_sim.pca9685[s_sim.pca9685_pointer];
+		__pca9685_advance_pointer();
+	}
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_i2c_write_register_byte(peripheral_i2c_h i2c, uint8_t reg, uint8_t data)
+{
+	uint8_t buf[2] = { reg, data };
+
+	return peripheral_i2c_write(i2c, buf, sizeof(buf));
+}
+
+int peripheral_i2c_read_register_byte(peripheral_i2c_h i2c, uint8_t reg, uint8_t *data)
+{
+	if (!__i2c_handle_valid(i2c) || !data)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	/* register address write followed by repeated start and one byte read */
+	__i2c_transaction(2);
+	if (__fault()) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_IO_ERROR;
+	}
+	s_sim.pca9685_pointer = reg;
+	*data = s_sim.pca9685[reg];
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+static sim_gpio_pin_s *__gpio_pin(peripheral_gpio_h gpio)
+{
+	if (!gpio || gpio->pin < 0 || gpio->pin >= PERIPHERAL_SIM_GPIO_MAX)
+		return NULL;
+
+	return &s_sim.pins[gpio->pin];
+}
+
+int peripheral_gpio_open(int gpio_pin, peripheral_gpio_h *gpio)
+{
+	sim_gpio_pin_s *pin;
+
+	if (!gpio || gpio_pin < 0 || gpio_pin >= PERIPHERAL_SIM_GPIO_MAX)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	pin = &s_sim.pins[gpio_pin];
+	if (pin->opened) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_RESOURCE_BUSY;
+	}
+	pin->opened = true;
+	pin->direction = PERIPHERAL_GPIO_DIRECTION_IN;
+	pin->edge = PERIPHERAL_GPIO_EDGE_NONE;
+	pin->cb = NULL;
+	pin->cb_data = NULL;
+	pin->handle.pin = gpio_pin;
+	*gpio = &pin->handle;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_close(peripheral_gpio_h gpio)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	pin->opened = false;
+	pin->cb = NULL;
+	pin->cb_data = NULL;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_set_direction(peripheral_gpio_h gpio, peripheral_gpio_direction_e direction)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin || direction > PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_LOW)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	pin->direction = direction;
+	if (direction == PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_HIGH)
+		pin->value = 1;
+	else if (direction == PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_LOW)
+		pin->value = 0;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_set_edge_mode(peripheral_gpio_h gpio, peripheral_gpio_edge_e edge)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin || edge > PERIPHERAL_GPIO_EDGE_BOTH)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	if (pin->direction != PERIPHERAL_GPIO_DIRECTION_IN) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_INVALID_OPERATION;
+	}
+	pin->edge = edge;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_set_interrupted_cb(peripheral_gpio_h gpio, peripheral_gpio_interrupted_cb callback, void *user_data)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin || !callback)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	pin->cb = callback;
+	pin->cb_data = user_data;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_unset_interrupted_cb(peripheral_gpio_h gpio)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	pin->cb = NULL;
+	pin->cb_data = NULL;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_read(peripheral_gpio_h gpio, uint32_t *value)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin || !value)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	s_sim.stats.gpio_reads++;
+	__busy_wait_us(s_sim.latency.gpio_us);
+	if (__fault()) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_IO_ERROR;
+	}
+	*value = pin->value;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+int peripheral_gpio_write(peripheral_gpio_h gpio, uint32_t value)
+{
+	sim_gpio_pin_s *pin = __gpio_pin(gpio);
+
+	if (!pin)
+		return PERIPHERAL_ERROR_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&s_sim.lock);
+	if (pin->direction == PERIPHERAL_GPIO_DIRECTION_IN) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_INVALID_OPERATION;
+	}
+	s_sim.stats.gpio_writes++;
+	__busy_wait_us(s_sim.latency.gpio_us);
+	if (__fault()) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return PERIPHERAL_ERROR_IO_ERROR;
+	}
+	pin->value = value ? 1 : 0;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return PERIPHERAL_ERROR_NONE;
+}
+
+void peripheral_sim_reset(void)
+{
+	int i;
+
+	pthread_mutex_lock(&s_sim.lock);
+	__pca9685_power_on();
+	for (i = 0; i < PERIPHERAL_SIM_GPIO_MAX; i++)
+		s_sim.pins[i].value = 0;
+	memset(&s_sim.stats, 0, sizeof(s_sim.stats));
+	s_sim.fail_count = 0;
+	pthread_mutex_unlock(&s_sim.lock);
+}
+
+void peripheral_sim_reset_stats(void)
+{
+	pthread_mutex_lock(&s_sim.lock);
+	memset(&s_sim.stats, 0, sizeof(s_sim.stats));
+	pthread_mutex_unlock(&s_sim.lock);
+}
+
+void peripheral_sim_set_latency(const peripheral_sim_latency_s *latency)
+{
+	pthread_mutex_lock(&s_sim.lock);
+	s_sim.latency = *latency;
+	pthread_mutex_unlock(&s_sim.lock);
+}
+
+void peripheral_sim_get_stats(peripheral_sim_stats_s *stats)
+{
+	pthread_mutex_lock(&s_sim.lock);
+	*stats = s_sim.stats;
+	pthread_mutex_unlock(&s_sim.lock);
+}
+
+void peripheral_sim_fail_next(unsigned int count)
+{
+	pthread_mutex_lock(&s_sim.lock);
+	s_sim.fail_count = count;
+	pthread_mutex_unlock(&s_sim.lock);
+}
+
+uint8_t peripheral_sim_pca9685_get_register(uint8_t reg)
+{
+	uint8_t value;
+
+	pthread_mutex_lock(&s_sim.lock);
+	value = s_sim.pca9685[reg];
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return value;
+}
+
+int peripheral_sim_pca9685_get_channel(unsigned int channel, unsigned int *on, unsigned int *off)
+{
+	const uint8_t *regs;
+
+	if (channel >= PERIPHERAL_SIM_PCA9685_CHANNELS)
+		return -1;
+
+	pthread_mutex_lock(&s_sim.lock);
+	regs = &s_sim.pca9685[PCA9685_LED0_ON_L + channel * PCA9685_CHANNEL_REG_COUNT];
+	*on = (regs[0] | (regs[1] << 8)) & 0x0FFF;
+	*off = (regs[2] | (regs[3] << 8)) & 0x0FFF;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return 0;
+}
+
+int peripheral_sim_pca9685_set_channel(unsigned int channel, unsigned int on, unsigned int off)
+{
+	uint8_t *regs;
+
+	if (channel >= PERIPHERAL_SIM_PCA9685_CHANNELS)
+		return -1;
+
+	pthread_mutex_lock(&s_sim.lock);
+	regs = &s_sim.pca9685[PCA9685_LED0_ON_L + channel * PCA9685_CHANNEL_REG_COUNT];
+	regs[0] = on & 0xFF;
+	regs[1] = (on >> 8) & 0x0F;
+	regs[2] = off & 0xFF;
+	regs[3] = (off >> 8) & 0x0F;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return 0;
+}
+
+int peripheral_sim_gpio_get_value(int pin, uint32_t *value)
+{
+	if (pin < 0 || pin >= PERIPHERAL_SIM_GPIO_MAX)
+		return -1;
+
+	pthread_mutex_lock(&s_sim.lock);
+	*value = s_sim.pins[pin].value;
+	pthread_mutex_unlock(&s_sim.lock);
+
+	return 0;
+}
+
+int peripheral_sim_gpio_inject(int pin, uint32_t value)
+{
+	sim_gpio_pin_s *p;
+	uint32_t old_value;
+	bool fire = false;
+	peripheral_gpio_interrupted_cb cb = NULL;
+	void *cb_data = NULL;
+
+	if (pin < 0 || pin >= PERIPHERAL_SIM_GPIO_MAX)
+		return -1;
+
+	value = value ? 1 : 0;
+
+	pthread_mutex_lock(&s_sim.lock);
+	p = &s_sim.pins[pin];
+	if (p->opened && p->direction != PERIPHERAL_GPIO_DIRECTION_IN) {
+		pthread_mutex_unlock(&s_sim.lock);
+		return -1;
+	}
+
+	old_value = p->value;
+	p->value = value;
+
+	if (p->opened && p->cb && old_value != value) {
+		switch (p->edge) {
+		case PERIPHERAL_GPIO_EDGE_RISING:
+			fire = value == 1;
+			break;
+		case PERIPHERAL_GPIO_EDGE_FALLING:
+			fire = value == 0;
+			break;
+		case PERIPHERAL_GPIO_EDGE_BOTH:
+			fire = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (fire) {
+		s_sim.stats.interrupts++;
+		cb = p->cb;
+		cb_data = p->cb_data;
+	}
+	pthread_mutex_unlock(&s_sim.lock);
+
+	/* callback usually reads the pin back, so it runs unlocked */
+	if (cb)
+		cb(&p->handle, PERIPHERAL_ERROR_NONE, cb_data);
+
+	return 0;
+}
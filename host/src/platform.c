@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlog.h>
+#include <app_common.h>
+
+#define DEFAULT_DATA_PATH "/tmp/"
+
+static log_priority s_min_priority = DLOG_INFO;
+
+static const char *const s_priority_tag[DLOG_PRIO_MAX] = {
+	"?", "?", "V", "D", "I", "W", "E", "F", "S",
+};
+
+void dlog_set_min_priority(log_priority prio)
+{
+	s_min_priority = prio;
+}
+
+int dlog_vprint(log_priority prio, const char *tag, const char *fmt, va_list ap)
+{
+	int ret;
+
+	if (prio < s_min_priority || prio >= DLOG_PRIO_MAX)
+		return 0;
+
+	fprintf(stderr, "%s/%s: ", s_priority_tag[prio], tag);
+	ret = vfprintf(stderr, fmt, ap);
+
+	return ret;
+}
+
+int dlog_print(log_priority prio, const char *tag, const char *fmt, ...)
+{
+	va_list ap;
+	int ret;
+
+	va_start(ap, fmt);
+	ret = dlog_vprint(prio, tag, fmt, ap);
+	va_end(ap);
+
+	return ret;
+}
+
+char *app_get_data_path(void)
+{
+	const char *path = getenv("CAR_APP_DATA_PATH");
+
+	return strdup(path ? path : DEFAULT_DATA_PATH);
+}
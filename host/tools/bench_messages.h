@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Sample messages for host benchmarks, one per MESSAGE_SCHEMA entry
+ * with all payload fields filled.
+ */
+
+#ifndef BENCH_MESSAGES_H
+#define BENCH_MESSAGES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "messages/message_types.h"
+#include "messages/message_batch.h"
+
+#define DATAGRAM_MAX_SIZE 512
+
+typedef union {
+#define BENCH_MESSAGES_MEMBER(TYPE, name, FIELDS) message_##name##_t name;
+	MESSAGE_SCHEMA(BENCH_MESSAGES_MEMBER)
+#undef BENCH_MESSAGES_MEMBER
+} any_message_u;
+
+static inline void __fill_int32(message_field_int32_t *value, unsigned int i)
+{
+	*value = (int32_t)(i * 2654435761u);
+}
+
+static inline void __fill_int64(message_field_int64_t *value, unsigned int i)
+{
+	*value = (int64_t)i << 33 | i;
+}
+
+static inline void __fill_bool(message_field_bool_t *value, unsigned int i)
+{
+	*value = i & 1;
+}
+
+static inline void __fill_version(message_field_version_t *value, unsigned int i)
+{
+	*value = MESSAGE_WIRE_VERSION_MAX;
+}
+
+static inline void __fill_role(message_field_role_t *value, unsigned int i)
+{
+	*value = MESSAGE_ROLE_OBSERVER;
+}
+
+static inline void __fill_command(message_field_command_t *value, unsigned int i)
+{
+	value->type = COMMAND_TYPE_DRIVE_AND_CAMERA;
+	value->data.steering_and_camera.speed = (int)(i % 20001) - 10000;
+	value->data.steering_and_camera.direction = 10000 - (int)(i % 20001);
+	value->data.steering_and_camera.camera_elevation = (int)(i % 101);
+	value->data.steering_and_camera.camera_azimuth = -(int)(i % 101);
+}
+
+/* keep-alive and drive command, like controllers send them together */
+static inline void __fill_batch(message_field_batch_t *value, unsigned int i)
+{
+	static writer_t entries;
+	static message_batch_t batch;
+	message_keep_alive_t keep_alive;
+	message_command_t command;
+
+	if (!entries.data) {
+		message_batch_init(&batch);
+		message_keep_alive_init(&keep_alive);
+		message_command_init(&command);
+		__fill_command(&command.command, i);
+		if (writer_init_sized(&entries, DATAGRAM_MAX_SIZE) ||
+				message_batch_append(&batch, &entries, &keep_alive.base, MESSAGE_WIRE_VERSION_MAX) ||
+				message_batch_append(&batch, &entries, &command.base, MESSAGE_WIRE_VERSION_MAX)) {
+			fprintf(stderr, "failed to build batch\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	*value = batch.entries;
+}
+
+#define BENCH_MESSAGES_FILL(kind, member, default) __fill_##kind(&message->member, i);
+
+#define BENCH_MESSAGES_INIT(TYPE, name, FIELDS) \
+	static inline message_t *__init_##name(any_message_u *any, unsigned int i) \
+	{ \
+		message_##name##_t *message = &any->name; \
+		message_##name##_init(message); \
+		FIELDS(BENCH_MESSAGES_FILL) \
+		(void)i; \
+		return &message->base; \
+	}
+
+MESSAGE_SCHEMA(BENCH_MESSAGES_INIT)
+
+#undef BENCH_MESSAGES_INIT
+#undef BENCH_MESSAGES_FILL
+
+typedef message_t *(*bench_message_init_fn)(any_message_u *any, unsigned int i);
+
+/**
+ * @brief Sample message of one schema type.
+ */
+typedef struct bench_message {
+	const char *name;           /** Schema name of the message */
+	bench_message_init_fn init; /** Initializes message in union and fills its fields from seed */
+} bench_message_s;
+
+#define BENCH_MESSAGES_ENTRY(TYPE, name, FIELDS) { #name, __init_##name },
+
+static const bench_message_s bench_messages[] = {
+	MESSAGE_SCHEMA(BENCH_MESSAGES_ENTRY)
+};
+
+#undef BENCH_MESSAGES_ENTRY
+
+#define BENCH_MESSAGES_COUNT (sizeof(bench_messages) / sizeof(bench_messages[0]))
+
+#endif /* end of include guard: BENCH_MESSAGES_H */
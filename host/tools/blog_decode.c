@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Renders binary log written in LOG_TYPE_BINARY mode (log.bin) as text.
+ *
+ *   blog-decode [-p] log.bin
+ *
+ * Records are printed oldest first, -p prints call site table instead.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "log_binary.h"
+
+#define SPEC_MAX 64
+
+typedef struct site_info {
+	const log_binary_site_s *entry;
+	const char *tag;
+	const char *func;
+	const char *fmt;
+} site_info_s;
+
+static const char *s_prio_names[] = {
+	"?", "?", "V", "D", "I", "W", "E", "F", "S",
+};
+
+static int __compare_slots(const void *a, const void *b)
+{
+	const log_binary_slot_s *sa = *(const log_binary_slot_s * const *)a;
+	const log_binary_slot_s *sb = *(const log_binary_slot_s * const *)b;
+
+	return sa->seq < sb->seq ? -1 : sa->seq > sb->seq;
+}
+
+typedef struct payload_reader {
+	const uint8_t *data;
+	size_t length;
+	size_t offset;
+} payload_reader_s;
+
+static int __take(payload_reader_s *reader, void *out, size_t size)
+{
+	if (reader->offset + size > reader->length)
+		return -1;
+
+	memcpy(out, reader->data + reader->offset, size);
+	reader->offset += size;
+	return 0;
+}
+
+/* rebuilds conversion spec with star values filled in and length modifier replaced */
+static void __build_spec(const char *fmt, const log_binary_conversion_s *conv,
+	int width, int precision, const char *length, char *spec)
+{
+	size_t i = conv->start + 1;
+	int n = 0;
+
+	spec[n++] = '%';
+	while (strchr("-+ #0'", fmt[i]) && n < SPEC_MAX - 32)
+		spec[n++] = fmt[i++];
+
+	if (fmt[i] == '*') {
+		n += snprintf(spec + n, SPEC_MAX - n, "%d", width);
+		i++;
+	} else {
+		while (fmt[i] >= '0' && fmt[i] <= '9' && n < SPEC_MAX - 24)
+			spec[n++] = fmt[i++];
+	}
+
+	if (fmt[i] == '.') {
+		spec[n++] = fmt[i++];
+		if (fmt[i] == '*') {
+			n += snprintf(spec + n, SPEC_MAX - n, "%d", precision);
+			i++;
+		} else {
+			while (fmt[i] >= '0' && fmt[i] <= '9' && n < SPEC_MAX - 16)
+				spec[n++] = fmt[i++];
+		}
+	}
+
+	while (strchr("hlLzjt", fmt[i]))
+		i++;
+
+	n += snprintf(spec + n, SPEC_MAX - n, "%s%c", length, fmt[conv->end - 1]);
+}
+
+static void __render(const site_info_s *site, const log_binary_slot_s *slot, FILE *out)
+{
+	payload_reader_s reader = { slot->payload, slot->length, 0 };
+	log_binary_conversion_s conv;
+	char spec[SPEC_MAX];
+	size_t pos = 0;
+	size_t last = 0;
+	int index = 0;
+	int width = 0, precision = 0;
+	int32_t i32;
+	uint64_t u64;
+	double d;
+	uint8_t len;
+	char str[256];
+	int missing;
+
+	while (!log_binary_next_conversion(site->fmt, &pos, &conv)) {
+		fwrite(site->fmt + last, 1, conv.start - last, out);
+		last = conv.end;
+
+		/* "[%s:%d] " prefix is stored with call site */
+		if (index == 0) {
+			fputs(site->func, out);
+			index++;
+			continue;
+		} else if (index == 1) {
+			fprintf(out, "%u", site->entry->line);
+			index++;
+			continue;
+		}
+		index++;
+
+		missing = 0;
+		if (conv.star_width)
+			missing |= __take(&reader, &width, sizeof(int32_t));
+		if (conv.star_precision)
+			missing |= __take(&reader, &precision, sizeof(int32_t));
+
+		switch (conv.type) {
+		case LOG_BINARY_ARG_NONE:
+			fputc('%', out);
+			break;
+		case LOG_BINARY_ARG_INT:
+			if (missing || __take(&reader, &i32, sizeof(i32)))
+				goto MISSING;
+			__build_spec(site->fmt, &conv, width, precision, "", spec);
+			fprintf(out, spec, i32);
+			break;
+		case LOG_BINARY_ARG_LONG:
+		case LOG_BINARY_ARG_LLONG:
+		case LOG_BINARY_ARG_SIZE:
+			if (missing || __take(&reader, &u64, sizeof(u64)))
+				goto MISSING;
+			__build_spec(site->fmt, &conv, width, precision, "ll", spec);
+			fprintf(out, spec, (unsigned long long)u64);
+			break;
+		case LOG_BINARY_ARG_DOUBLE:
+		case LOG_BINARY_ARG_LDOUBLE:
+			if (missing || __take(&reader, &d, sizeof(d)))
+				goto MISSING;
+			__build_spec(site->fmt, &conv, width, precision, "", spec);
+			fprintf(out, spec, d);
+			break;
+		case LOG_BINARY_ARG_STRING:
+			if (missing || __take(&reader, &len, 1) || __take(&reader, str, len))
+				goto MISSING;
+			str[len] = '\0';
+			__build_spec(site->fmt, &conv, width, precision, "", spec);
+			fprintf(out, spec, str);
+			break;
+		case LOG_BINARY_ARG_POINTER:
+			if (missing || __take(&reader, &u64, sizeof(u64)))
+				goto MISSING;
+			fprintf(out, "0x%llx", (unsigned long long)u64);
+			break;
+		}
+		continue;
+MISSING:
+		fputs("<?>", out);
+	}
+
+	fputs(site->fmt + last, out);
+}
+
+static void __print_time(int64_t timestamp, FILE *out)
+{
+	time_t sec = timestamp / 1000000000LL;
+	struct tm tm;
+
+	localtime_r(&sec, &tm);
+	fprintf(out, "%04d-%02d-%02d %02d:%02d:%02d.%06lld ",
+		tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+		tm.tm_hour, tm.tm_min, tm.tm_sec,
+		(long long)(timestamp % 1000000000LL) / 1000);
+}
+
+int main(int argc, char *argv[])
+{
+	const log_binary_header_s *header;
+	const uint8_t *sites_region;
+	const log_binary_slot_s *slots;
+	const log_binary_slot_s **ordered;
+	site_info_s *sites;
+	uint8_t *data;
+	size_t size;
+	size_t offset;
+	size_t used;
+	size_t count = 0;
+	size_t i;
+	int print_sites = 0;
+	const char *path;
+	FILE *in;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "ph")) != -1) {
+		switch (opt) {
+		case 'p':
+			print_sites = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-p] log.bin\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind != argc - 1) {
+		fprintf(stderr, "usage: %s [-p] log.bin\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	path = argv[optind];
+
+	in = fopen(path, "rb");
+	if (!in) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+	fseek(in, 0, SEEK_END);
+	size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	data = malloc(size);
+	if (!data || fread(data, 1, size, in) != size) {
+		fprintf(stderr, "failed to read %s\n", path);
+		return EXIT_FAILURE;
+	}
+	fclose(in);
+
+	header = (const log_binary_header_s *)data;
+	if (size < sizeof(*header) || memcmp(header->magic, LOG_BINARY_MAGIC, sizeof(LOG_BINARY_MAGIC))
+			|| header->version != LOG_BINARY_VERSION || header->slot_size != LOG_BINARY_SLOT_SIZE
+			|| size < sizeof(*header) + header->sites_size + (size_t)header->slot_size * header->slot_count) {
+		fprintf(stderr, "%s is not a binary log of version %d\n", path, LOG_BINARY_VERSION);
+		return EXIT_FAILURE;
+	}
+
+	sites_region = data + sizeof(*header);
+	slots = (const log_binary_slot_s *)(sites_region + header->sites_size);
+
+	sites = calloc(header->site_count + 1, sizeof(site_info_s));
+	ordered = calloc(header->slot_count, sizeof(*ordered));
+	if (!sites || !ordered) {
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	used = header->sites_used < header->sites_size ? header->sites_used : header->sites_size;
+	for (offset = 0; offset + sizeof(log_binary_site_s) <= used;) {
+		const log_binary_site_s *entry = (const log_binary_site_s *)(sites_region + offset);
+
+		if (entry->size == 0 || offset + entry->size > used)
+			break;
+		if (entry->id && entry->id <= header->site_count) {
+			sites[entry->id].entry = entry;
+			sites[entry->id].tag = entry->strings;
+			sites[entry->id].func = sites[entry->id].tag + strlen(sites[entry->id].tag) + 1;
+			sites[entry->id].fmt = sites[entry->id].func + strlen(sites[entry->id].func) + 1;
+			if (print_sites)
+				printf("%5u %s %s %s:%u %s", entry->id, s_prio_names[entry->prio < 9 ? entry->prio : 0],
+					sites[entry->id].tag, sites[entry->id].func, entry->line, sites[entry->id].fmt);
+		}
+		offset += entry->size;
+	}
+	if (print_sites)
+		return EXIT_SUCCESS;
+
+	for (i = 0; i < header->slot_count; i++) {
+		if (slots[i].seq && slots[i].site && slots[i].site <= header->site_count && sites[slots[i].site].entry)
+			ordered[count++] = &slots[i];
+	}
+	qsort(ordered, count, sizeof(*ordered), __compare_slots);
+
+	if (count && ordered[0]->seq > 1)
+		printf("-- %llu older records overwritten --\n", (unsigned long long)ordered[0]->seq - 1);
+
+	for (i = 0; i < count; i++) {
+		const site_info_s *site = &sites[ordered[i]->site];
+
+		__print_time(ordered[i]->timestamp, stdout);
+		printf("%s/%s: ", s_prio_names[site->entry->prio < 9 ? site->entry->prio : 0], site->tag);
+		__render(site, ordered[i], stdout);
+		if (ordered[i]->truncated)
+			printf("   ^ arguments truncated\n");
+	}
+
+	free(ordered);
+	free(sites);
+	free(data);
+
+	return EXIT_SUCCESS;
+}
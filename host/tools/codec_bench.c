@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Benchmark and fuzzer of message codecs generated from MESSAGE_SCHEMA.
+ *
+ * For every message type and wire version fills payload fields, then
+ * measures encoding, decoding and in place validation of the datagram. Encoded datagrams
+ * are checked to survive decode/encode round trip, and randomly mutated
+ * copies are checked to be either rejected by validation or decoded
+ * without error, so validator and decoder never disagree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "messages/message_codec.h"
+#include "messages/message_view.h"
+#include "messages/clock.h"
+#include "bench_messages.h"
+
+#define DEFAULT_ITERATIONS 1000000
+#define DEFAULT_FUZZ_ITERATIONS 100000
+
+static volatile int sink;
+
+static void __usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-n iterations] [-f fuzz_iterations] [-s seed]\n", name);
+}
+
+static int __encode(message_t *message, message_wire_version_e version, char *data, size_t *size)
+{
+	writer_t writer;
+
+	if (writer_init_sized(&writer, DATAGRAM_MAX_SIZE))
+		return -1;
+
+	if (message_encode(message, &writer, version) || writer.length > DATAGRAM_MAX_SIZE) {
+		writer_shutdown(&writer);
+		return -1;
+	}
+
+	memcpy(data, writer.data, writer.length);
+	*size = writer.length;
+	writer_shutdown(&writer);
+	return 0;
+}
+
+static int __decode(const char *data, size_t size, any_message_u *any, bench_message_init_fn init)
+{
+	reader_t reader;
+
+	reader_init_static(&reader, data, size);
+	return message_decode(init(any, 0), &reader);
+}
+
+static int __check_roundtrip(const char *name, message_t *message, message_wire_version_e version,
+		bench_message_init_fn init)
+{
+	char data[DATAGRAM_MAX_SIZE], again[DATAGRAM_MAX_SIZE];
+	size_t size, again_size;
+	any_message_u decoded;
+
+	if (__encode(message, version, data, &size)) {
+		fprintf(stderr, "FAIL: %s: encoding failed\n", name);
+		return -1;
+	}
+
+	if (__decode(data, size, &decoded, init) || __encode((message_t *)&decoded, version, again, &again_size)) {
+		fprintf(stderr, "FAIL: %s: decoding failed\n", name);
+		return -1;
+	}
+
+	if (size != again_size || memcmp(data, again, size)) {
+		fprintf(stderr, "FAIL: %s: round trip changed datagram\n", name);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int __fuzz(const char *name, const char *data, size_t size, unsigned int iterations,
+		bench_message_init_fn init)
+{
+	static const endpoint_t sender = {0, };
+	char mutated[DATAGRAM_MAX_SIZE];
+	unsigned int i, flips, accepted = 0;
+	size_t mutated_size;
+	message_view_t view;
+	any_message_u decoded;
+	message_view_batch_iter_t iter;
+	message_view_t sub;
+	command_s command;
+	int64_t serial;
+
+	for (i = 0; i < iterations; i++) {
+		memcpy(mutated, data, size);
+		mutated_size = size;
+
+		for (flips = rand() % 4; flips > 0; flips--)
+			mutated[rand() % size] ^= 1 << (rand() % 8);
+		if (rand() % 4 == 0)
+			mutated_size = rand() % (size + 1);
+
+		if (message_view_init(&view, mutated, mutated_size, &sender))
+			continue;
+		accepted++;
+
+		/* view accepted payload of its own type, decoders must agree */
+		if (message_view_get_type(&view) == MESSAGE_COMMAND && message_view_get_command(&view, &command)) {
+			fprintf(stderr, "FAIL: %s: validated COMMAND payload not decoded\n", name);
+			return -1;
+		}
+		if (message_view_get_type(&view) == MESSAGE_ACK && message_view_get_ack_serial(&view, &serial)) {
+			fprintf(stderr, "FAIL: %s: validated ACK payload not decoded\n", name);
+			return -1;
+		}
+		if (message_view_get_type(&view) == MESSAGE_BATCH) {
+			if (message_view_batch_begin(&view, &iter)) {
+				fprintf(stderr, "FAIL: %s: validated BATCH payload not iterated\n", name);
+				return -1;
+			}
+			while (message_view_batch_next(&iter, &sub))
+				sink += message_view_get_type(&sub);
+		}
+		if (message_view_get_type(&view) == message_get_type(init(&decoded, 0)) &&
+				__decode(mutated, mutated_size, &decoded, init)) {
+			fprintf(stderr, "FAIL: %s: validated datagram not decoded\n", name);
+			return -1;
+		}
+	}
+
+	printf("  fuzz:      %u mutations, %u accepted\n", iterations, accepted);
+	return 0;
+}
+
+static int __bench(const char *name, bench_message_init_fn init,
+		message_wire_version_e version, unsigned int iterations, unsigned int fuzz_iterations)
+{
+	static const endpoint_t sender = {0, };
+	char data[DATAGRAM_MAX_SIZE];
+	size_t size;
+	any_message_u any, decoded;
+	message_t *message = init(&any, 1);
+	message_view_t view;
+	writer_t writer;
+	reader_t reader;
+	int64_t t0, t1, t2, t3;
+	unsigned int i;
+
+	printf("%s (v%d):\n", name, version);
+
+	if (__check_roundtrip(name, message, version, init) || __encode(message, version, data, &size))
+		return -1;
+
+	if (writer_init_sized(&writer, DATAGRAM_MAX_SIZE))
+		return -1;
+
+	t0 = clock_monotonic_ns_get();
+	for (i = 0; i < iterations; i++) {
+		writer_reset(&writer, 0);
+		sink += message_encode(message, &writer, version);
+	}
+	t1 = clock_monotonic_ns_get();
+	for (i = 0; i < iterations; i++) {
+		reader_init_static(&reader, data, size);
+		/* all schema types share base offset in the union */
+		decoded.connect.base.type = message_get_type(message);
+		sink += message_decode(&decoded.connect.base, &reader);
+	}
+	t2 = clock_monotonic_ns_get();
+	for (i = 0; i < iterations; i++)
+		sink += message_view_init(&view, data, size, &sender);
+	t3 = clock_monotonic_ns_get();
+
+	writer_shutdown(&writer);
+
+	printf("  size:      %zu bytes\n", size);
+	printf("  encode:    %.1f ns\n", (double)(t1 - t0) / iterations);
+	printf("  decode:    %.1f ns\n", (double)(t2 - t1) / iterations);
+	printf("  view:      %.1f ns\n", (double)(t3 - t2) / iterations);
+
+	return __fuzz(name, data, size, fuzz_iterations, init);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iterations = DEFAULT_ITERATIONS;
+	unsigned int fuzz_iterations = DEFAULT_FUZZ_ITERATIONS;
+	unsigned int seed = 1;
+	message_wire_version_e version;
+	unsigned int i;
+	int ret = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:f:s:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = strtoul(optarg, NULL, 10);
+			break;
+		case 'f':
+			fuzz_iterations = strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			__usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (iterations == 0) {
+		__usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	srand(seed);
+
+	for (version = MESSAGE_WIRE_V1; version <= MESSAGE_WIRE_VERSION_MAX; version++) {
+		for (i = 0; i < BENCH_MESSAGES_COUNT; i++)
+			ret |= __bench(bench_messages[i].name, bench_messages[i].init, version, iterations, fuzz_iterations);
+	}
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Decode throughput benchmark over a captured packet corpus.
+ *
+ * Corpus is a classic pcap file, e.g. recorded on the car with:
+ *
+ *   tcpdump -i wlan0 -w corpus.pcap udp port 4004
+ *
+ * UDP payloads sent to or from the car port are loaded into memory once,
+ * then decoded repeatedly in the two ways the car can do it:
+ * - view:   in place validation with message_view_init and payload getters,
+ * - decode: full decoding into factory messages.
+ * Without captured traffic, -o writes synthetic corpus with controller
+ * like mix of messages, which can be replayed by the tool afterwards.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <endian.h>
+#include "messages/message_factory.h"
+#include "messages/message_view.h"
+#include "messages/clock.h"
+#include "bench_messages.h"
+
+#define DEFAULT_ROUNDS 100
+#define DEFAULT_PACKETS 10000
+#define DEFAULT_PORT 4004
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_RECORD_HEADER_SIZE 16
+#define PCAP_SNAPLEN 65535
+
+#define LINKTYPE_NULL 0
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW 101
+#define LINKTYPE_LINUX_SLL 113
+
+#define ETHERTYPE_IPV4 0x0800
+#define ETHERTYPE_VLAN 0x8100
+#define ETHERTYPE_IPV6 0x86dd
+#define IPPROTO_UDP_ 17
+
+typedef struct pcap_header {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+} pcap_header_s;
+
+typedef struct packet {
+	const char *data; /** UDP payload, points into corpus file buffer */
+	size_t size;      /** Length of @data */
+} packet_s;
+
+typedef struct corpus {
+	char *file;        /** Whole corpus file */
+	packet_s *packets; /** Extracted datagrams */
+	unsigned int count;
+	size_t bytes;      /** Sum of datagram sizes */
+} corpus_s;
+
+static volatile int64_t sink;
+
+static void __usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-n rounds] [-p port] corpus.pcap...\n"
+		"       %s -o corpus.pcap [-c packets] [-w wire_version]\n", name, name);
+}
+
+static uint16_t __be16(const unsigned char *p)
+{
+	return p[0] << 8 | p[1];
+}
+
+static uint32_t __u32(const unsigned char *p, int swapped)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return swapped ? __builtin_bswap32(v) : v;
+}
+
+/* returns UDP payload of IPv4 or IPv6 packet, NULL for other packets */
+static const unsigned char *__udp_payload(const unsigned char *ip, size_t size, int port, size_t *payload_size)
+{
+	const unsigned char *udp;
+	size_t header, length;
+
+	if (size < 1)
+		return NULL;
+
+	switch (ip[0] >> 4) {
+	case 4:
+		header = (ip[0] & 0x0f) * 4;
+		/* fragments other than complete datagrams are skipped */
+		if (size < 20 || header < 20 || ip[9] != IPPROTO_UDP_ || (__be16(ip + 6) & 0x3fff))
+			return NULL;
+		break;
+	case 6:
+		header = 40;
+		if (size < header || ip[6] != IPPROTO_UDP_)
+			return NULL;
+		break;
+	default:
+		return NULL;
+	}
+
+	if (size < header + 8)
+		return NULL;
+
+	udp = ip + header;
+	if (port && __be16(udp) != port && __be16(udp + 2) != port)
+		return NULL;
+
+	length = __be16(udp + 4);
+	if (length < 8 || header + length > size)
+		return NULL;
+
+	*payload_size = length - 8;
+	return udp + 8;
+}
+
+static const unsigned char *__link_payload(uint32_t linktype, const unsigned char *frame, size_t size, size_t *ip_size)
+{
+	size_t header;
+	uint16_t ethertype;
+
+	switch (linktype) {
+	case LINKTYPE_ETHERNET:
+		if (size < 14)
+			return NULL;
+		header = 14;
+		ethertype = __be16(frame + 12);
+		if (ethertype == ETHERTYPE_VLAN && size >= 18) {
+			header = 18;
+			ethertype = __be16(frame + 16);
+		}
+		break;
+	case LINKTYPE_LINUX_SLL:
+		if (size < 16)
+			return NULL;
+		header = 16;
+		ethertype = __be16(frame + 14);
+		break;
+	case LINKTYPE_NULL:
+		header = 4;
+		ethertype = ETHERTYPE_IPV4;
+		break;
+	case LINKTYPE_RAW:
+		header = 0;
+		ethertype = ETHERTYPE_IPV4;
+		break;
+	default:
+		return NULL;
+	}
+
+	if (ethertype != ETHERTYPE_IPV4 && ethertype != ETHERTYPE_IPV6)
+		return NULL;
+	if (size < header)
+		return NULL;
+
+	*ip_size = size - header;
+	return frame + header;
+}
+
+static char *__read_file(const char *path, size_t *size)
+{
+	FILE *file = fopen(path, "rb");
+	char *data = NULL;
+	long length;
+
+	if (!file)
+		return NULL;
+
+	if (fseek(file, 0, SEEK_END) || (length = ftell(file)) < 0 || fseek(file, 0, SEEK_SET))
+		goto out;
+
+	data = malloc(length ? length : 1);
+	if (data && fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		data = NULL;
+	}
+	*size = length;
+
+out:
+	fclose(file);
+	return data;
+}
+
+static int __corpus_load(corpus_s *corpus, const char *path, int port)
+{
+	const unsigned char *data, *frame, *ip, *payload;
+	size_t size, offset, frame_size, ip_size, payload_size;
+	uint32_t magic, linktype;
+	unsigned int records = 0, capacity = 0;
+	packet_s *packets;
+	int swapped;
+
+	memset(corpus, 0, sizeof(*corpus));
+
+	corpus->file = __read_file(path, &size);
+	if (!corpus->file) {
+		fprintf(stderr, "%s: cannot read file\n", path);
+		return -1;
+	}
+	data = (const unsigned char *)corpus->file;
+
+	if (size < sizeof(pcap_header_s))
+		goto invalid;
+
+	memcpy(&magic, data, sizeof(magic));
+	if (magic == PCAP_MAGIC || magic == PCAP_MAGIC_NS)
+		swapped = 0;
+	else if (magic == __builtin_bswap32(PCAP_MAGIC) || magic == __builtin_bswap32(PCAP_MAGIC_NS))
+		swapped = 1;
+	else
+		goto invalid;
+
+	linktype = __u32(data + offsetof(pcap_header_s, linktype), swapped) & 0xffff;
+
+	for (offset = sizeof(pcap_header_s); offset + PCAP_RECORD_HEADER_SIZE <= size; offset += frame_size) {
+		frame_size = __u32(data + offset + 8, swapped);
+		offset += PCAP_RECORD_HEADER_SIZE;
+		if (frame_size > size - offset)
+			goto invalid;
+		frame = data + offset;
+		records++;
+
+		ip = __link_payload(linktype, frame, frame_size, &ip_size);
+		if (!ip)
+			continue;
+		payload = __udp_payload(ip, ip_size, port, &payload_size);
+		if (!payload)
+			continue;
+
+		if (corpus->count == capacity) {
+			capacity = capacity ? capacity * 2 : 1024;
+			packets = realloc(corpus->packets, capacity * sizeof(*packets));
+			if (!packets)
+				goto invalid;
+			corpus->packets = packets;
+		}
+
+		corpus->packets[corpus->count].data = (const char *)payload;
+		corpus->packets[corpus->count].size = payload_size;
+		corpus->bytes += payload_size;
+		corpus->count++;
+	}
+
+	printf("%s: %u records, %u datagrams, %zu bytes\n", path, records, corpus->count, corpus->bytes);
+	return 0;
+
+invalid:
+	fprintf(stderr, "%s: not a valid pcap file\n", path);
+	free(corpus->packets);
+	free(corpus->file);
+	return -1;
+}
+
+static void __corpus_destroy(corpus_s *corpus)
+{
+	free(corpus->packets);
+	free(corpus->file);
+}
+
+static int __view_packet(const packet_s *packet)
+{
+	static const endpoint_t sender = {0, };
+	message_view_batch_iter_t iter;
+	message_view_t view, sub;
+	command_s command;
+	int64_t serial;
+
+	if (message_view_init(&view, packet->data, packet->size, &sender))
+		return -1;
+
+	switch (message_view_get_type(&view)) {
+	case MESSAGE_COMMAND:
+		message_view_get_command(&view, &command);
+		sink += command.type;
+		break;
+	case MESSAGE_ACK:
+		message_view_get_ack_serial(&view, &serial);
+		sink += serial;
+		break;
+	case MESSAGE_BATCH:
+		message_view_batch_begin(&view, &iter);
+		while (message_view_batch_next(&iter, &sub))
+			sink += message_view_get_serial(&sub);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static int __decode_packet(message_factory_t *factory, const packet_s *packet)
+{
+	message_t *message;
+	reader_t reader;
+	int32_t type;
+
+	reader_init_static(&reader, packet->data, packet->size);
+	if (packet->size > 0 && (packet->data[0] & MESSAGE_WIRE_V2_MARK))
+		type = (unsigned char)packet->data[0] & ~MESSAGE_WIRE_V2_MARK;
+	else if (reader_read_int32(&reader, &type))
+		return -1;
+
+	message = message_factory_create_message(factory, type);
+	if (!message)
+		return -1;
+
+	reader_reset(&reader);
+	if (message_decode(message, &reader))
+		return -1;
+
+	sink += message_get_serial(message);
+	return 0;
+}
+
+static int __bench(const corpus_s *corpus, unsigned int rounds)
+{
+	message_factory_t *factory = message_factory_create();
+	unsigned int rejected[2] = {0, 0};
+	unsigned int round, i, mode;
+	int64_t t0, t1;
+	double ns;
+	static const char *modes[] = {"view", "decode"};
+
+	if (!factory)
+		return -1;
+
+	for (mode = 0; mode < 2; mode++) {
+		t0 = clock_monotonic_ns_get();
+		for (round = 0; round < rounds; round++) {
+			for (i = 0; i < corpus->count; i++) {
+				if (mode == 0 ? __view_packet(&corpus->packets[i]) :
+						__decode_packet(factory, &corpus->packets[i]))
+					rejected[mode]++;
+			}
+		}
+		t1 = clock_monotonic_ns_get();
+
+		ns = (double)(t1 - t0) / ((double)rounds * corpus->count);
+		printf("  %-7s %7.1f ns/packet %8.2f Mpps %8.1f MB/s  %u rejected\n", modes[mode], ns, 1000.0 / ns,
+				(double)corpus->bytes * rounds * 1000.0 / (t1 - t0), rejected[mode] / rounds);
+	}
+
+	message_factory_destroy(factory);
+	return 0;
+}
+
+static void __put_u16(unsigned char *p, uint16_t v)
+{
+	p[0] = v >> 8;
+	p[1] = v;
+}
+
+static int __write_packet(FILE *file, unsigned int i, const char *payload, size_t size)
+{
+	unsigned char frame[14 + 20 + 8];
+	uint32_t record[4];
+
+	/* Ethernet, IPv4 and UDP headers, checksums are not verified by the reader */
+	memset(frame, 0, sizeof(frame));
+	__put_u16(frame + 12, ETHERTYPE_IPV4);
+	frame[14] = 0x45;
+	__put_u16(frame + 16, 20 + 8 + size);
+	frame[22] = 64;
+	frame[23] = IPPROTO_UDP_;
+	memcpy(frame + 26, (const unsigned char[]){192, 168, 0, 2}, 4);
+	memcpy(frame + 30, (const unsigned char[]){192, 168, 0, 1}, 4);
+	__put_u16(frame + 34, 40000);
+	__put_u16(frame + 36, DEFAULT_PORT);
+	__put_u16(frame + 38, 8 + size);
+
+	/* controller sends commands every 20 ms */
+	record[0] = i / 50;
+	record[1] = i % 50 * 20000;
+	record[2] = record[3] = sizeof(frame) + size;
+
+	if (fwrite(record, sizeof(record), 1, file) != 1 ||
+			fwrite(frame, sizeof(frame), 1, file) != 1 ||
+			fwrite(payload, size, 1, file) != 1)
+		return -1;
+	return 0;
+}
+
+static int __write_corpus(const char *path, unsigned int count, int version)
+{
+	/* controller traffic: mostly commands, keep alives and acks in between */
+	static const char *mix[] = {
+		"command", "command", "command", "command", "command", "command",
+		"keep_alive", "ack", "command", "batch",
+	};
+	const pcap_header_s header = {
+		.magic = PCAP_MAGIC,
+		.version_major = 2,
+		.version_minor = 4,
+		.snaplen = PCAP_SNAPLEN,
+		.linktype = LINKTYPE_ETHERNET,
+	};
+	char storage[DATAGRAM_MAX_SIZE];
+	any_message_u any;
+	writer_t writer;
+	unsigned int i, j;
+	FILE *file;
+	int err = 0;
+
+	file = fopen(path, "wb");
+	if (!file) {
+		fprintf(stderr, "%s: cannot create file\n", path);
+		return -1;
+	}
+
+	err |= fwrite(&header, sizeof(header), 1, file) != 1;
+
+	for (i = 0; i < count && !err; i++) {
+		for (j = 0; j < BENCH_MESSAGES_COUNT; j++) {
+			if (!strcmp(bench_messages[j].name, mix[i % (sizeof(mix) / sizeof(mix[0]))]))
+				break;
+		}
+		if (j == BENCH_MESSAGES_COUNT) {
+			err = -1;
+			break;
+		}
+
+		writer_init_static(&writer, storage, sizeof(storage));
+		err |= message_encode(bench_messages[j].init(&any, i), &writer,
+				version ? version : (i / 2) % MESSAGE_WIRE_VERSION_MAX + 1);
+		err |= __write_packet(file, i, writer.data, writer.length);
+	}
+
+	if (fclose(file) || err) {
+		fprintf(stderr, "%s: writing corpus failed\n", path);
+		return -1;
+	}
+
+	printf("%s: %u datagrams written\n", path, count);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int rounds = DEFAULT_ROUNDS;
+	unsigned int count = DEFAULT_PACKETS;
+	const char *output = NULL;
+	int port = DEFAULT_PORT;
+	int version = 0;
+	corpus_s corpus;
+	int ret = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:p:o:c:w:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			rounds = strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			port = strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'c':
+			count = strtoul(optarg, NULL, 10);
+			break;
+		case 'w':
+			version = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			__usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (output) {
+		if (version < 0 || version > MESSAGE_WIRE_VERSION_MAX) {
+			__usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		return __write_corpus(output, count, version) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	if (rounds == 0 || optind == argc || port < 0 || port > UINT16_MAX) {
+		__usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for (; optind < argc; optind++) {
+		if (__corpus_load(&corpus, argv[optind], port)) {
+			ret = -1;
+			continue;
+		}
+		if (corpus.count > 0)
+			ret |= __bench(&corpus, rounds);
+		__corpus_destroy(&corpus);
+	}
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
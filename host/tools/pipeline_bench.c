@@ -0,0 +1,503 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host benchmark of the command -> actuator pipeline.
+ *
+ * Encodes a stream of COMMAND messages the way controller does, then
+ * for every message runs the same steps as the car: type prefix and
+ * message decoding, command mapping and servo/motor drivers on top of
+ * the peripheral simulator. Finally checks actuator state for known
+ * commands and failsafe ramp-down, so the tool also works as
+ * a regression check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <dlog.h>
+#include "peripheral_sim.h"
+#include "car_control.h"
+#include "latency.h"
+#include "log.h"
+#include "resource.h"
+#include "resource/resource_PCA9685.h"
+#include "messages/message_command.h"
+#include "messages/message_view.h"
+#include "messages/clock.h"
+
+#define DEFAULT_COMMAND_COUNT 10000
+#define SERVO_CH 0
+#define MOTOR1_PIN_1 19
+#define MOTOR1_PIN_2 16
+#define MOTOR1_EN_CH 5
+#define MOTOR2_PIN_1 26
+#define MOTOR2_PIN_2 20
+#define MOTOR2_EN_CH 4
+
+typedef struct encoded_command {
+	char *data;
+	size_t size;
+} encoded_command_s;
+
+static void __usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-n commands] [-t i2c_transaction_us] [-b i2c_byte_us] [-g gpio_us] [-s] [-v] [-a] [-r]\n"
+		"  -s  write PCA9685 registers one by one instead of auto-increment bursts\n"
+		"  -a  use async logging\n"
+		"  -r  record binary log to $CAR_APP_DATA_PATH/log.bin\n"
+		"  -v  print debug logs of the pipeline\n", name);
+}
+
+static command_s __command_at(unsigned int i)
+{
+	command_s command = { .type = COMMAND_TYPE_DRIVE };
+
+	/* steps are held for a few commands, like a joystick sampled faster than it moves */
+	command.data.steering.speed = ((int)((i / 8) % 41) - 20) * 50;
+	command.data.steering.direction = ((int)((i / 4) % 21) - 10) * 100;
+
+	return command;
+}
+
+static int __encode(const command_s *command, encoded_command_s *out)
+{
+	message_command_t msg;
+	writer_t writer;
+	int ret = 0;
+
+	if (writer_init_sized(&writer, 64))
+		return -1;
+
+	message_command_init(&msg);
+	message_command_set_command(&msg, command);
+
+	ret |= writer_write_int32(&writer, MESSAGE_COMMAND);
+	ret |= message_serialize(&msg.base, &writer);
+	message_command_destroy(&msg);
+
+	if (ret) {
+		writer_shutdown(&writer);
+		return -1;
+	}
+
+	out->data = writer.data;
+	out->size = writer.length;
+
+	return 0;
+}
+
+static int __decode(const encoded_command_s *in, command_s *command)
+{
+	static const endpoint_t sender = {0, };
+	message_view_t view;
+
+	if (message_view_init(&view, in->data, in->size, &sender))
+		return -1;
+	latency_trace_mark(LATENCY_POINT_DESERIALIZED);
+
+	return message_view_get_command(&view, command);
+}
+
+static int __expect_channel(unsigned int ch, unsigned int off)
+{
+	unsigned int on_v, off_v;
+
+	peripheral_sim_pca9685_get_channel(ch, &on_v, &off_v);
+	if (on_v != 0 || off_v != off) {
+		fprintf(stderr, "FAIL: channel %u is [%u, %u], expected [0, %u]\n", ch, on_v, off_v, off);
+		return -1;
+	}
+	return 0;
+}
+
+static int __expect_pin(int pin, uint32_t value)
+{
+	uint32_t v;
+
+	peripheral_sim_gpio_get_value(pin, &v);
+	if (v != value) {
+		fprintf(stderr, "FAIL: gpio %d is %u, expected %u\n", pin, v, value);
+		return -1;
+	}
+	return 0;
+}
+
+static int __check_actuators(void)
+{
+	command_s command = { .type = COMMAND_TYPE_DRIVE };
+	int err = 0;
+
+	/* full speed forward, full right */
+	command.data.steering.speed = 1000;
+	command.data.steering.direction = 1000;
+	car_control_apply(&command);
+	err |= __expect_channel(SERVO_CH, 500);
+	err |= __expect_channel(MOTOR1_EN_CH, 4095);
+	err |= __expect_channel(MOTOR2_EN_CH, 4095);
+	err |= __expect_pin(MOTOR1_PIN_1, 1);
+	err |= __expect_pin(MOTOR1_PIN_2, 0);
+	err |= __expect_pin(MOTOR2_PIN_1, 1);
+	err |= __expect_pin(MOTOR2_PIN_2, 0);
+
+	/* half speed backward, full left */
+	command.data.steering.speed = -500;
+	command.data.steering.direction = -1000;
+	car_control_apply(&command);
+	err |= __expect_channel(SERVO_CH, 400);
+	err |= __expect_channel(MOTOR1_EN_CH, 2048);
+	err |= __expect_pin(MOTOR1_PIN_1, 0);
+	err |= __expect_pin(MOTOR1_PIN_2, 1);
+
+	/* neutral brakes motors */
+	command.data.steering.speed = 0;
+	command.data.steering.direction = 0;
+	car_control_apply(&command);
+	err |= __expect_channel(SERVO_CH, 450);
+	err |= __expect_channel(MOTOR1_EN_CH, 0);
+	err |= __expect_channel(MOTOR2_EN_CH, 0);
+	err |= __expect_pin(MOTOR1_PIN_1, 1);
+	err |= __expect_pin(MOTOR1_PIN_2, 1);
+
+	return err;
+}
+
+static int __check_failsafe(void)
+{
+	command_s command = { .type = COMMAND_TYPE_DRIVE };
+	failsafe_config_s config;
+	failsafe_t failsafe;
+	int64_t now = 0;
+	int speed = 0, direction = 0, last = 1000, steps = 0;
+	failsafe_action_e action;
+	int err = 0;
+	int i;
+
+	/* stream of commands every 20 ms, deadline is clamped to the minimum */
+	failsafe_config_default(&config);
+	failsafe_init(&failsafe, &config);
+	command.data.steering.speed = 1000;
+	command.data.steering.direction = 300;
+	for (i = 0; i < 10; i++, now += 20 * CLOCK_NS_PER_MS)
+		failsafe_command(&failsafe, &command, now);
+	now -= 20 * CLOCK_NS_PER_MS;
+
+	if (failsafe_get_timeout(&failsafe) != config.timeout_ns ||
+			failsafe_poll(&failsafe, now + config.timeout_ns - config.step_ns, &speed, &direction) != FAILSAFE_ACTION_NONE) {
+		fprintf(stderr, "FAIL: failsafe tripped before deadline\n");
+		err = -1;
+	}
+
+	/* speed has to decrease monotonically and end with brake */
+	now += config.timeout_ns;
+	while ((action = failsafe_poll(&failsafe, now, &speed, &direction)) == FAILSAFE_ACTION_DECAY) {
+		if (speed >= last || direction != 300) {
+			fprintf(stderr, "FAIL: failsafe speed %d after %d\n", speed, last);
+			return -1;
+		}
+		last = speed;
+		steps++;
+		now += config.step_ns;
+	}
+	if (action != FAILSAFE_ACTION_BRAKE || failsafe_is_active(&failsafe) ||
+			steps * config.step_ns * config.deceleration < (1000 - config.brake_speed - config.deceleration / 50) * CLOCK_NS_PER_SEC) {
+		fprintf(stderr, "FAIL: failsafe stopped after %d steps\n", steps);
+		err = -1;
+	}
+
+	/* silent controller brakes motors through car control */
+	config.timeout_ns = 0;
+	config.deceleration = 1000000;
+	car_control_failsafe_init(&config);
+	car_control_apply(&command);
+	if (!car_control_failsafe_is_active() || car_control_failsafe_check()) {
+		fprintf(stderr, "FAIL: car control failsafe did not stop\n");
+		err = -1;
+	}
+	err |= __expect_channel(MOTOR1_EN_CH, 0);
+	err |= __expect_channel(MOTOR2_EN_CH, 0);
+	/* braking from forward drive pulls both pins low */
+	err |= __expect_pin(MOTOR1_PIN_1, 0);
+	err |= __expect_pin(MOTOR1_PIN_2, 0);
+
+	return err;
+}
+
+static void __fill_channel_values(unsigned int i, pca9685_channel_value_s values[3])
+{
+	command_s command = __command_at(i);
+	int speed = abs(command.data.steering.speed) * 4095 / 1000;
+
+	/* same channels car control drives per command, enable channels are adjacent */
+	values[0] = (pca9685_channel_value_s){ SERVO_CH, 0, 450 + command.data.steering.direction / 20 };
+	values[1] = (pca9685_channel_value_s){ MOTOR2_EN_CH, 0, speed };
+	values[2] = (pca9685_channel_value_s){ MOTOR1_EN_CH, 0, speed };
+}
+
+static int __bench_multi_channel(unsigned int count)
+{
+	pca9685_channel_value_s values[3];
+	pca9685_stats_s single, multi;
+	unsigned int i, j;
+
+	resource_pca9685_invalidate_cache();
+	resource_pca9685_reset_stats();
+	for (i = 0; i < count; i++) {
+		__fill_channel_values(i, values);
+		for (j = 0; j < 3; j++)
+			if (resource_pca9685_set_value_to_channel(values[j].channel, values[j].on, values[j].off))
+				return -1;
+	}
+	resource_pca9685_get_stats(&single);
+
+	resource_pca9685_invalidate_cache();
+	resource_pca9685_reset_stats();
+	for (i = 0; i < count; i++) {
+		__fill_channel_values(i, values);
+		if (resource_pca9685_set_values_to_channels(values, 3))
+			return -1;
+	}
+	resource_pca9685_get_stats(&multi);
+
+	printf("multi-channel write: %.2f -> %.2f transactions, %.3f us saved per command\n",
+		(double)single.transactions / count, (double)multi.transactions / count,
+		((double)single.time_ns - (double)multi.time_ns) / 1000.0 / count);
+
+	return 0;
+}
+
+static int __check_resync(void)
+{
+	pca9685_stats_s stats;
+	unsigned int on_v, off_v;
+	int err = 0;
+
+	if (resource_pca9685_set_value_to_channel(SERVO_CH, 0, 420))
+		return -1;
+
+	/* glitch the driver does not see, shadow still says 420 */
+	peripheral_sim_pca9685_set_channel(SERVO_CH, 0, 123);
+	if (resource_pca9685_resync_cache())
+		return -1;
+
+	/* shadow has to match the chip, so writing what chip holds is a cache hit */
+	resource_pca9685_reset_stats();
+	resource_pca9685_set_value_to_channel(SERVO_CH, 0, 123);
+	resource_pca9685_get_stats(&stats);
+	if (stats.cache_hits != 1 || stats.transactions) {
+		fprintf(stderr, "FAIL: shadow of channel %u does not match chip after resync\n", SERVO_CH);
+		err = -1;
+	}
+
+	/* and the value lost by the glitch reaches the chip again */
+	resource_pca9685_set_value_to_channel(SERVO_CH, 0, 420);
+	err |= __expect_channel(SERVO_CH, 420);
+
+	/* untouched channels keep their shadow */
+	peripheral_sim_pca9685_get_channel(MOTOR1_EN_CH, &on_v, &off_v);
+	resource_pca9685_reset_stats();
+	resource_pca9685_set_value_to_channel(MOTOR1_EN_CH, on_v, off_v);
+	resource_pca9685_get_stats(&stats);
+	if (stats.cache_hits != 1) {
+		fprintf(stderr, "FAIL: shadow of channel %u lost by resync\n", MOTOR1_EN_CH);
+		err = -1;
+	}
+
+	return err;
+}
+
+static void __print_latency(void)
+{
+	latency_summary_s summary;
+	int stage;
+
+	printf("%-20s %10s %10s %10s %10s %10s\n", "stage [us]", "mean", "p50", "p99", "p99.9", "max");
+	for (stage = LATENCY_STAGE_DESERIALIZE; stage < LATENCY_STAGE_MAX; stage++) {
+		latency_get_summary(stage, &summary);
+		if (!summary.count)
+			continue;
+		printf("%-20s %10.3f %10.3f %10.3f %10.3f %10.3f\n", latency_stage_name(stage),
+			summary.mean / 1000.0, summary.p50 / 1000.0, summary.p99 / 1000.0,
+			summary.p999 / 1000.0, summary.max / 1000.0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	peripheral_sim_latency_s latency = {0, };
+	peripheral_sim_stats_s sim_stats;
+	pca9685_stats_s pca_stats;
+	motor_driver_L298N_stats_s motor_stats;
+	encoded_command_s *encoded;
+	unsigned int count = DEFAULT_COMMAND_COUNT;
+	unsigned int i;
+	bool burst = true;
+	bool verbose = false;
+	bool async_log = false;
+	bool binary_log = false;
+	log_async_stats_s log_stats;
+	int64_t t0, t1, t2;
+	int64_t decode_ns = 0, apply_ns = 0, apply_max_ns = 0;
+	command_s command;
+	int opt;
+	int ret = EXIT_SUCCESS;
+
+	while ((opt = getopt(argc, argv, "n:t:b:g:svarh")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = strtoul(optarg, NULL, 10);
+			break;
+		case 't':
+			latency.i2c_transaction_us = strtoul(optarg, NULL, 10);
+			break;
+		case 'b':
+			latency.i2c_byte_us = strtoul(optarg, NULL, 10);
+			break;
+		case 'g':
+			latency.gpio_us = strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			burst = false;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		case 'a':
+			async_log = true;
+			break;
+		case 'r':
+			binary_log = true;
+			break;
+		default:
+			__usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (count == 0) {
+		__usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	dlog_set_min_priority(verbose ? DLOG_DEBUG : DLOG_WARN);
+	log_level_set(verbose ? DLOG_DEBUG : DLOG_WARN);
+	if (binary_log)
+		log_type_set(LOG_TYPE_BINARY);
+	if (async_log && log_async_start(0)) {
+		fprintf(stderr, "failed to start async logging\n");
+		return EXIT_FAILURE;
+	}
+
+	encoded = calloc(count, sizeof(encoded_command_s));
+	if (!encoded) {
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < count; i++) {
+		command = __command_at(i);
+		if (__encode(&command, &encoded[i])) {
+			fprintf(stderr, "failed to encode command %u\n", i);
+			return EXIT_FAILURE;
+		}
+	}
+
+	resource_set_motor_driver_L298N_configuration(MOTOR_ID_1, MOTOR1_PIN_1, MOTOR1_PIN_2, MOTOR1_EN_CH);
+	resource_set_motor_driver_L298N_configuration(MOTOR_ID_2, MOTOR2_PIN_1, MOTOR2_PIN_2, MOTOR2_EN_CH);
+	resource_pca9685_set_burst_write(burst);
+
+	/* opens drivers and programs PCA9685 outside of measured part */
+	command = __command_at(0);
+	car_control_apply(&command);
+
+	peripheral_sim_reset_stats();
+	resource_pca9685_reset_stats();
+	latency_reset();
+	peripheral_sim_set_latency(&latency);
+
+	for (i = 0; i < count; i++) {
+		t0 = clock_monotonic_ns_get();
+		latency_trace_begin_at(t0);
+		if (__decode(&encoded[i], &command)) {
+			fprintf(stderr, "failed to decode command %u\n", i);
+			ret = EXIT_FAILURE;
+			break;
+		}
+		t1 = clock_monotonic_ns_get();
+		car_control_apply(&command);
+		t2 = clock_monotonic_ns_get();
+
+		decode_ns += t1 - t0;
+		apply_ns += t2 - t1;
+		if (t2 - t1 > apply_max_ns)
+			apply_max_ns = t2 - t1;
+	}
+
+	peripheral_sim_get_stats(&sim_stats);
+	resource_pca9685_get_stats(&pca_stats);
+	resource_motor_driver_L298N_get_stats(&motor_stats);
+
+	printf("commands:            %u (%s writes)\n", count, burst ? "burst" : "single-register");
+	printf("latency:             i2c %uus + %uus/byte, gpio %uus\n",
+		latency.i2c_transaction_us, latency.i2c_byte_us, latency.gpio_us);
+	printf("decode avg:          %.3f us\n", decode_ns / 1000.0 / count);
+	printf("apply avg / max:     %.3f / %.3f us\n", apply_ns / 1000.0 / count, apply_max_ns / 1000.0);
+	printf("i2c per command:     %.2f transactions, %.2f bytes\n",
+		(double)sim_stats.i2c_transactions / count, (double)sim_stats.i2c_bytes / count);
+	printf("gpio per command:    %.2f writes\n", (double)sim_stats.gpio_writes / count);
+	printf("i2c us per command:  %.3f\n", pca_stats.time_ns / 1000.0 / count);
+	printf("pca9685 cache:       %llu hits, %llu misses\n", pca_stats.cache_hits, pca_stats.cache_misses);
+	printf("l298n cache:         %llu hits, %llu misses\n", motor_stats.hits, motor_stats.misses);
+	if (async_log) {
+		log_async_get_stats(&log_stats);
+		printf("async log:           %llu written, %llu dropped\n", log_stats.written, log_stats.dropped);
+	}
+	__print_latency();
+
+	if (ret == EXIT_SUCCESS && __bench_multi_channel(count)) {
+		fprintf(stderr, "FAIL: multi-channel write\n");
+		ret = EXIT_FAILURE;
+	}
+
+	peripheral_sim_set_latency(&(peripheral_sim_latency_s){0, });
+	if (ret == EXIT_SUCCESS && __check_actuators()) {
+		ret = EXIT_FAILURE;
+	} else if (ret == EXIT_SUCCESS) {
+		printf("actuator check:      OK\n");
+	}
+	if (ret == EXIT_SUCCESS && __check_failsafe()) {
+		ret = EXIT_FAILURE;
+	} else if (ret == EXIT_SUCCESS) {
+		printf("failsafe check:      OK\n");
+	}
+	if (ret == EXIT_SUCCESS && __check_resync()) {
+		ret = EXIT_FAILURE;
+	} else if (ret == EXIT_SUCCESS) {
+		printf("resync check:        OK\n");
+	}
+
+	resource_close_all();
+	log_file_close();
+	for (i = 0; i < count; i++)
+		free(encoded[i].data);
+	free(encoded);
+
+	return ret;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Microbenchmark of message serialization into different writer storage.
+ *
+ * For every message type and wire version encodes the same message
+ * many times into:
+ * - grow:     new heap writer starting from 1 byte, grown on demand,
+ * - reuse:    one heap writer reset before every message,
+ * - reserve:  like reuse, with writer_reserve of the datagram size,
+ * - fixed:    caller provided stack storage, no heap use at all.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "messages/message.h"
+#include "messages/clock.h"
+#include "bench_messages.h"
+
+#define DEFAULT_ITERATIONS 1000000
+
+typedef enum {
+	STORAGE_GROW,
+	STORAGE_REUSE,
+	STORAGE_RESERVE,
+	STORAGE_FIXED,
+	STORAGE_MAX
+} storage_e;
+
+static const char *storage_names[STORAGE_MAX] = {
+	[STORAGE_GROW] = "grow",
+	[STORAGE_REUSE] = "reuse",
+	[STORAGE_RESERVE] = "reserve",
+	[STORAGE_FIXED] = "fixed",
+};
+
+static volatile size_t sink;
+
+static void __usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-n iterations] [-w wire_version]\n", name);
+}
+
+static int __run(storage_e storage, message_t *message, message_wire_version_e version, unsigned int iterations)
+{
+	char storage_buf[DATAGRAM_MAX_SIZE];
+	writer_t writer;
+	unsigned int i;
+	int err = 0;
+
+	switch (storage) {
+	case STORAGE_GROW:
+		for (i = 0; i < iterations; i++) {
+			err |= writer_init_sized(&writer, 1);
+			err |= message_encode(message, &writer, version);
+			sink += writer.length;
+			writer_shutdown(&writer);
+		}
+		return err;
+	case STORAGE_REUSE:
+	case STORAGE_RESERVE:
+		err |= writer_init_sized(&writer, 1);
+		for (i = 0; i < iterations; i++) {
+			writer_reset(&writer, 0);
+			if (storage == STORAGE_RESERVE)
+				err |= writer_reserve(&writer, DATAGRAM_MAX_SIZE);
+			err |= message_encode(message, &writer, version);
+			sink += writer.length;
+		}
+		writer_shutdown(&writer);
+		return err;
+	case STORAGE_FIXED:
+		for (i = 0; i < iterations; i++) {
+			writer_init_static(&writer, storage_buf, sizeof(storage_buf));
+			err |= message_encode(message, &writer, version);
+			sink += writer.length;
+		}
+		return err;
+	default:
+		return -1;
+	}
+}
+
+static int __bench(const bench_message_s *sample, message_wire_version_e version, unsigned int iterations)
+{
+	char buf[DATAGRAM_MAX_SIZE];
+	any_message_u any;
+	message_t *message = sample->init(&any, 1);
+	writer_t writer;
+	storage_e storage;
+	int64_t t0, t1;
+	double ns;
+
+	writer_init_static(&writer, buf, sizeof(buf));
+	if (message_encode(message, &writer, version)) {
+		fprintf(stderr, "FAIL: %s: encoding failed\n", sample->name);
+		return -1;
+	}
+
+	printf("%-17s v%d %4zu B", sample->name, version, writer.length);
+	for (storage = 0; storage < STORAGE_MAX; storage++) {
+		t0 = clock_monotonic_ns_get();
+		if (__run(storage, message, version, iterations)) {
+			fprintf(stderr, "\nFAIL: %s: %s storage failed\n", sample->name, storage_names[storage]);
+			return -1;
+		}
+		t1 = clock_monotonic_ns_get();
+
+		ns = (double)(t1 - t0) / iterations;
+		printf("  %7.1f ns %7.1f MB/s", ns, writer.length * 1000.0 / ns);
+	}
+	printf("\n");
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iterations = DEFAULT_ITERATIONS;
+	message_wire_version_e first = MESSAGE_WIRE_V1, last = MESSAGE_WIRE_VERSION_MAX;
+	message_wire_version_e version;
+	storage_e storage;
+	unsigned int i;
+	int ret = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:w:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = strtoul(optarg, NULL, 10);
+			break;
+		case 'w':
+			first = last = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			__usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (iterations == 0 || first < MESSAGE_WIRE_V1 || last > MESSAGE_WIRE_VERSION_MAX) {
+		__usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	printf("%-17s %2s %6s", "message", "", "size");
+	for (storage = 0; storage < STORAGE_MAX; storage++)
+		printf("  %-23s", storage_names[storage]);
+	printf("\n");
+
+	for (version = first; version <= last; version++) {
+		for (i = 0; i < BENCH_MESSAGES_COUNT; i++)
+			ret |= __bench(&bench_messages[i], version, iterations);
+	}
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_CAR_CONTROL_H_
+#define INC_CAR_CONTROL_H_
+
+#include <stdbool.h>
+#include "command.h"
+#include "failsafe.h"
+
+/**
+ * @brief Maps command values to actuator ranges and drives servo and motors.
+ * @param[in] command Command to apply.
+ * @remarks Depends only on resource layer, so it builds against
+ * the host peripheral simulator as well.
+ */
+void car_control_apply(const command_s *command);
+
+/**
+ * @brief Enables failsafe, which ramps motors down when commands stop.
+ * @param[in] config Failsafe parameters, see @failsafe_config_default.
+ */
+void car_control_failsafe_init(const failsafe_config_s *config);
+
+/**
+ * @brief Checks if @car_control_failsafe_check has to be called periodically.
+ * @return true while car moves under failsafe supervision.
+ */
+bool car_control_failsafe_is_active(void);
+
+/**
+ * @brief Starts ramping motors down at once, e.g. on controller disconnect.
+ */
+void car_control_failsafe_trip(void);
+
+/**
+ * @brief Checks command deadline and applies decayed speed or brakes.
+ * @return true if the check has to be repeated, false when car stopped.
+ * @remarks Has to be called every failsafe step while
+ * @car_control_failsafe_is_active returns true.
+ */
+bool car_control_failsafe_check(void);
+
+#endif /* INC_CAR_CONTROL_H_ */
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_CONNECTION_TABLE_H_
+#define INC_CONNECTION_TABLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "endpoint.h"
+#include "messages/message.h"
+
+#define CONNECTION_TABLE_CAPACITY 8
+#define CONNECTION_TABLE_SLOTS (2 * CONNECTION_TABLE_CAPACITY) //Power of two
+
+/**
+ * @brief Session of the connection table.
+ */
+typedef struct connection_table_entry {
+	endpoint_t endpoint;  /** Controller of the session */
+	message_role_e role;  /** Role granted to the controller */
+	bool used;            /** Entry holds a session */
+} connection_table_entry_s;
+
+/**
+ * @brief Fixed capacity table of controller sessions.
+ *
+ * Sessions are kept in an array, so callers may keep their own session
+ * data in arrays indexed the same way. Endpoints are mapped to indexes
+ * by open addressing hash, which is at most half full, so a lookup
+ * takes one or two probes.
+ */
+typedef struct connection_table {
+	connection_table_entry_s entries[CONNECTION_TABLE_CAPACITY];
+	int8_t slots[CONNECTION_TABLE_SLOTS]; /** Index of entry per hash slot, -1 if empty */
+	unsigned int count;                   /** Number of sessions */
+} connection_table_t;
+
+/**
+ * @brief Initializes empty table.
+ *
+ * @param[in] table table object.
+ */
+void connection_table_init(connection_table_t *table);
+
+/**
+ * @brief Finds session of the endpoint.
+ *
+ * @param[in] table table object.
+ * @param[in] endpoint controller endpoint.
+ *
+ * @return index of the session, -1 if there is none.
+ */
+int connection_table_find(const connection_table_t *table, const endpoint_t *endpoint);
+
+/**
+ * @brief Adds session of the endpoint.
+ *
+ * @param[in] table table object.
+ * @param[in] endpoint controller endpoint.
+ * @param[in] role role granted to the controller.
+ *
+ * @return index of the new session, -1 if table is full or endpoint has a session already.
+ */
+int connection_table_add(connection_table_t *table, const endpoint_t *endpoint, message_role_e role);
+
+/**
+ * @brief Removes session.
+ *
+ * @param[in] table table object.
+ * @param[in] index index of the session.
+ */
+void connection_table_remove(connection_table_t *table, int index);
+
+/**
+ * @brief Gets session.
+ *
+ * @param[in] table table object.
+ * @param[in] index index of the session.
+ *
+ * @return session entry, check its @used flag when iterating.
+ */
+static inline const connection_table_entry_s *connection_table_get(const connection_table_t *table, int index)
+{
+	return &table->entries[index];
+}
+
+#endif /* INC_CONNECTION_TABLE_H_ */
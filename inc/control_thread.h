@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_CONTROL_THREAD_H_
+#define INC_CONTROL_THREAD_H_
+
+#include <stdbool.h>
+#include "command.h"
+
+/**
+ * @brief Scheduling parameters of control thread.
+ */
+typedef struct control_thread_config {
+	int priority; /** SCHED_FIFO priority, 0 keeps default scheduling policy. */
+	int cpu;      /** CPU the thread is pinned to, -1 disables pinning. */
+} control_thread_config_s;
+
+/**
+ * @brief Called in the control thread context.
+ * @param[in] user_data User data passed to control_thread_start.
+ */
+typedef void (*control_thread_cb)(void *user_data);
+
+/**
+ * @brief Called in the control thread for every command pushed with control_thread_push_command.
+ * @param[in] command Command to apply.
+ */
+typedef void (*control_thread_command_cb)(command_s command);
+
+/**
+ * @brief Starts control thread running its own main context.
+ * @param[in] config Scheduling parameters.
+ * @param[in] init_cb Called in the new thread before its loop starts.
+ * @param[in] fini_cb Called in the thread after its loop finishes.
+ * @param[in] command_cb Called in the thread for every pushed command.
+ * @param[in] user_data Data passed to init_cb and fini_cb.
+ * @return 0 on success, -1 otherwise.
+ * @remarks GLib sources created in init_cb on the thread-default main context
+ * (e.g. UDP socket watch and connection timers) are dispatched by the control thread
+ * and never by the application main loop.
+ */
+int control_thread_start(const control_thread_config_s *config, control_thread_cb init_cb, control_thread_cb fini_cb,
+		control_thread_command_cb command_cb, void *user_data);
+
+/**
+ * @brief Queues command for the control thread.
+ * @param[in] command Command to queue.
+ * @return 0 on success, -1 if thread is not running or queue is full.
+ * @remarks Must be called from a single thread only (e.g. application main loop).
+ */
+int control_thread_push_command(const command_s *command);
+
+/**
+ * @brief Checks if control thread is running.
+ * @return true if running, false otherwise.
+ */
+bool control_thread_is_running();
+
+/**
+ * @brief Stops the control thread and waits until fini_cb finishes.
+ */
+void control_thread_stop();
+
+#endif /* INC_CONTROL_THREAD_H_ */
@@ -18,7 +18,9 @@
 #define INC_CONTROLLER_CONNECTION_MANAGER_H_
 
 #include "command.h"
-#include "messages/message.h"
+#include "messages/message_view.h"
+#include "link_stats.h"
+#include "serial_window.h"
 /**
  * @brief Describes state of connection.
  */
@@ -44,9 +46,52 @@ typedef void (*command_received_cb)(command_s command);
  * @brief Starts listening on the given port for messages.
  * @return 0 on success, -1 otherwise.
  * @remarks This function allocates resources and that has to be freed with controller_connection_manager_release.
+ * @remarks Connection timers are attached to the thread-default main context of the calling thread.
  */
 int controller_connection_manager_listen();
 
+/**
+ * @brief Sets time after which silent controller is disconnected.
+ * @param[in] timeout_ms Timeout in milliseconds, 5000 by default.
+ * @remarks Every KEEP_ALIVE, COMMAND and BATCH message of the controller extends the deadline.
+ * Timers run on 10 ms ticks, so timeouts of a few hundred milliseconds are supported.
+ */
+void controller_connection_manager_set_keep_alive_timeout(unsigned int timeout_ms);
+
+/**
+ * @brief Sets interval of LINK_STATS messages sent to connected controller.
+ * @param[in] interval_ms Interval in milliseconds, 1000 by default, 0 disables the messages.
+ * @remarks Controller acknowledging LINK_STATS provides round trip time samples,
+ * without them only loss, reordering and jitter are estimated.
+ */
+void controller_connection_manager_set_link_stats_interval(unsigned int interval_ms);
+
+/**
+ * @brief Gets link statistics of the current controller session.
+ * @param[out] stats Statistics since the controller connected.
+ * @return 0 on success, -1 if no controller is connected.
+ */
+int controller_connection_manager_get_link_stats(link_stats_summary_s *stats);
+
+/**
+ * @brief Gets counters of duplicated and reordered messages of the current controller session.
+ * @param[out] stats Counters since the controller connected.
+ * @return 0 on success, -1 if no controller is connected.
+ * @remarks Duplicated and stale messages are dropped on arrival. COMMAND and KEEP_ALIVE
+ * messages older than the last handled one of the same type are dropped as well.
+ */
+int controller_connection_manager_get_serial_stats(serial_window_stats_s *stats);
+
+/**
+ * @brief Gets number of connected observers.
+ * @return Number of observers.
+ * @remarks Controllers sending CONNECT with MESSAGE_ROLE_OBSERVER are accepted as observers,
+ * up to 7 at time, regardless of connection state. They receive every applied COMMAND
+ * and LINK_STATS message, their commands are ignored. Like the driver, they have to send
+ * KEEP_ALIVE messages within keep alive timeout.
+ */
+unsigned int controller_connection_manager_get_observer_count();
+
 /**
  * @brief Gets currect connection state.
  * @return Connection state.
@@ -63,7 +108,7 @@ void controller_connection_manager_set_state_change_cb(connection_state_cb callb
  * @brief Handles arriving message.
  * @param[in] message Message to handle
  */
-void controller_connection_manager_handle_message(message_t *message);
+void controller_connection_manager_handle_message(const message_view_t *message);
 
 /**
  * @brief Sets callback function called whenever new message arrives.
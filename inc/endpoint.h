@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_ENDPOINT_H_
+#define INC_ENDPOINT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <netinet/in.h>
+
+/**
+ * @brief Length of buffer able to hold "xxx.xxx.xxx.xxx:ppppp" string.
+ */
+#define ENDPOINT_STR_LEN (INET_ADDRSTRLEN + 6)
+
+/**
+ * @brief IPv4 UDP endpoint in binary form.
+ */
+typedef struct endpoint {
+	uint32_t address; /** IPv4 address in network byte order. */
+	uint16_t port;    /** Port in host byte order. */
+} endpoint_t;
+
+/**
+ * @brief Compares two endpoints.
+ * @param[in] a First endpoint.
+ * @param[in] b Second endpoint.
+ * @return true if both address and port are equal, false otherwise.
+ */
+static inline bool endpoint_equal(const endpoint_t *a, const endpoint_t *b)
+{
+	return a->address == b->address && a->port == b->port;
+}
+
+/**
+ * @brief Hashes endpoint for hash tables.
+ * @param[in] endpoint Endpoint to hash.
+ * @return hash value, all bits are mixed.
+ */
+static inline uint32_t endpoint_hash(const endpoint_t *endpoint)
+{
+	uint64_t key = (uint64_t)endpoint->address << 16 | endpoint->port;
+
+	/* Fibonacci hashing, upper half of the product depends on all key bits */
+	return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+/**
+ * @brief Checks if endpoint holds any address.
+ * @param[in] endpoint Endpoint to check.
+ * @return true if endpoint was set, false if it is zeroed.
+ */
+static inline bool endpoint_is_set(const endpoint_t *endpoint)
+{
+	return endpoint->address != 0 || endpoint->port != 0;
+}
+
+/**
+ * @brief Fills endpoint from socket address.
+ * @param[out] endpoint Endpoint to fill.
+ * @param[in] addr Socket address.
+ */
+void endpoint_from_sockaddr(endpoint_t *endpoint, const struct sockaddr_in *addr);
+
+/**
+ * @brief Fills socket address from endpoint.
+ * @param[in] endpoint Endpoint.
+ * @param[out] addr Socket address to fill.
+ */
+void endpoint_to_sockaddr(const endpoint_t *endpoint, struct sockaddr_in *addr);
+
+/**
+ * @brief Parses textual IPv4 address.
+ * @param[out] endpoint Endpoint to fill.
+ * @param[in] ip IPv4 address in dotted notation.
+ * @param[in] port Port number.
+ * @return 0 on success, -1 otherwise.
+ */
+int endpoint_from_string(endpoint_t *endpoint, const char *ip, int port);
+
+/**
+ * @brief Formats endpoint as "ip:port" text.
+ * @param[in] endpoint Endpoint to format.
+ * @param[out] buf Output buffer, should be at least ENDPOINT_STR_LEN long.
+ * @param[in] len Length of buf.
+ * @return buf, so the function may be used directly as log argument.
+ * @remarks Meant for logging only, hot paths should compare endpoints in binary form.
+ */
+const char *endpoint_to_string(const endpoint_t *endpoint, char *buf, size_t len);
+
+#endif /* INC_ENDPOINT_H_ */
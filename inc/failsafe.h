@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_FAILSAFE_H_
+#define INC_FAILSAFE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "command.h"
+
+/**
+ * @brief Parameters of the failsafe.
+ */
+typedef struct failsafe_config {
+	int64_t timeout_ns;     /** Minimal silence after which speed starts to decay */
+	int64_t max_timeout_ns; /** Maximal silence after which speed starts to decay */
+	int interval_factor;    /** Silence of this many average command intervals is tolerated */
+	int deceleration;       /** Speed units removed per second while decaying */
+	int brake_speed;        /** Speed below which motors are braked at once */
+	int64_t step_ns;        /** Interval of @failsafe_poll calls while car moves */
+} failsafe_config_s;
+
+/**
+ * @brief Failsafe states.
+ */
+typedef enum failsafe_state {
+	FAILSAFE_STATE_IDLE,     /** Car does not move */
+	FAILSAFE_STATE_ARMED,    /** Car moves and commands arrive in time */
+	FAILSAFE_STATE_DECAYING, /** Commands stopped, speed is decreased */
+	FAILSAFE_STATE_STOPPED   /** Motors were braked by failsafe */
+} failsafe_state_e;
+
+/**
+ * @brief Actions requested by @failsafe_poll.
+ */
+typedef enum failsafe_action {
+	FAILSAFE_ACTION_NONE,  /** Nothing to do */
+	FAILSAFE_ACTION_DECAY, /** Decreased speed has to be applied */
+	FAILSAFE_ACTION_BRAKE  /** Motors have to be braked */
+} failsafe_action_e;
+
+/**
+ * @brief Failsafe between command source and the motors.
+ *
+ * Tracks time since last COMMAND and its average interval, so deadline
+ * follows rate at which the controller sends commands. Once deadline
+ * passes, speed decays linearly and motors are finally braked. Time is
+ * taken from the caller, so the failsafe can be driven by any timer.
+ */
+typedef struct failsafe {
+	failsafe_config_s config;
+	failsafe_state_e state;
+	int64_t last_command_ns; /** Arrival of the last COMMAND */
+	int64_t interval_ns;     /** Moving average of COMMAND intervals */
+	int64_t last_step_ns;    /** Time of the last decay step */
+	int speed;               /** Last applied speed */
+	int direction;           /** Last applied direction */
+} failsafe_t;
+
+/**
+ * @brief Fills config with default values.
+ *
+ * @param[out] config config object.
+ */
+void failsafe_config_default(failsafe_config_s *config);
+
+/**
+ * @brief Initializes failsafe.
+ *
+ * @param[in] failsafe failsafe object.
+ * @param[in] config failsafe parameters.
+ */
+void failsafe_init(failsafe_t *failsafe, const failsafe_config_s *config);
+
+/**
+ * @brief Records command passed to the motors.
+ *
+ * @param[in] failsafe failsafe object.
+ * @param[in] command command being applied.
+ * @param[in] now_ns current monotonic time.
+ *
+ * @note every command proves the controller is alive, only drive
+ * commands change the speed being tracked.
+ */
+void failsafe_command(failsafe_t *failsafe, const command_s *command, int64_t now_ns);
+
+/**
+ * @brief Starts decaying speed at once, e.g. when controller disconnects.
+ *
+ * @param[in] failsafe failsafe object.
+ * @param[in] now_ns current monotonic time.
+ */
+void failsafe_trip(failsafe_t *failsafe, int64_t now_ns);
+
+/**
+ * @brief Checks deadline and advances the deceleration profile.
+ *
+ * @param[in] failsafe failsafe object.
+ * @param[in] now_ns current monotonic time.
+ * @param[out] speed speed to be applied for FAILSAFE_ACTION_DECAY.
+ * @param[out] direction direction to be applied for FAILSAFE_ACTION_DECAY.
+ *
+ * @return action to be performed.
+ */
+failsafe_action_e failsafe_poll(failsafe_t *failsafe, int64_t now_ns, int *speed, int *direction);
+
+/**
+ * @brief Gets deadline of the current command stream.
+ *
+ * @param[in] failsafe failsafe object.
+ *
+ * @return tolerated silence in nanoseconds.
+ */
+int64_t failsafe_get_timeout(const failsafe_t *failsafe);
+
+/**
+ * @brief Checks if failsafe has to be polled.
+ *
+ * @param[in] failsafe failsafe object.
+ *
+ * @return true while car moves, false otherwise.
+ */
+static inline bool failsafe_is_active(const failsafe_t *failsafe)
+{
+	return failsafe->state == FAILSAFE_STATE_ARMED || failsafe->state == FAILSAFE_STATE_DECAYING;
+}
+
+#endif /* INC_FAILSAFE_H_ */
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_LATENCY_H_
+#define INC_LATENCY_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Points of the command path where timestamps are taken.
+ */
+typedef enum latency_point {
+	LATENCY_POINT_RECEIVED,     /** Datagram returned by socket receive call. */
+	LATENCY_POINT_DESERIALIZED, /** Message decoded. */
+	LATENCY_POINT_DISPATCHED,   /** Command handed to command callback. */
+	LATENCY_POINT_MAPPED,       /** Command mapped to actuator values. */
+	LATENCY_POINT_ACTUATED,     /** Last actuator register write completed. */
+	LATENCY_POINT_MAX
+} latency_point_e;
+
+/**
+ * @brief Histograms kept by the module.
+ *
+ * Every stage but LATENCY_STAGE_END_TO_END measures time between
+ * its point and the closest earlier point marked in the same trace.
+ */
+typedef enum latency_stage {
+	LATENCY_STAGE_DESERIALIZE = LATENCY_POINT_DESERIALIZED,
+	LATENCY_STAGE_DISPATCH = LATENCY_POINT_DISPATCHED,
+	LATENCY_STAGE_MAPPING = LATENCY_POINT_MAPPED,
+	LATENCY_STAGE_ACTUATE = LATENCY_POINT_ACTUATED,
+	LATENCY_STAGE_END_TO_END = LATENCY_POINT_MAX, /** RECEIVED to ACTUATED. */
+	LATENCY_STAGE_MAX
+} latency_stage_e;
+
+/**
+ * @brief Timestamps of one command, 0 for points not marked.
+ */
+typedef struct latency_trace {
+	int64_t points[LATENCY_POINT_MAX];
+} latency_trace_s;
+
+/**
+ * @brief Histogram summary, all values in nanoseconds.
+ */
+typedef struct latency_summary {
+	unsigned long long count;
+	int64_t mean;
+	int64_t p50;
+	int64_t p99;
+	int64_t p999;
+	int64_t max;
+} latency_summary_s;
+
+/**
+ * @brief Starts new trace of calling thread and marks LATENCY_POINT_RECEIVED.
+ * @remarks Timestamps come from clock_monotonic_ns_get.
+ */
+void latency_trace_begin(void);
+
+/**
+ * @brief Starts new trace of calling thread with LATENCY_POINT_RECEIVED set to @a received_ns.
+ * @remarks Used when several datagrams come from one receive call.
+ */
+void latency_trace_begin_at(int64_t received_ns);
+
+/**
+ * @brief Stores current time as @a point of calling thread's trace.
+ * @remarks Does nothing if no trace was started.
+ */
+void latency_trace_mark(latency_point_e point);
+
+/**
+ * @brief Records marked points of calling thread's trace into histograms and clears it.
+ */
+void latency_trace_end(void);
+
+/**
+ * @brief Copies calling thread's trace, e.g. to keep it with a deferred command.
+ */
+void latency_trace_save(latency_trace_s *trace);
+
+/**
+ * @brief Makes @a trace the calling thread's trace.
+ */
+void latency_trace_restore(const latency_trace_s *trace);
+
+/**
+ * @brief Computes summary of stage histogram.
+ */
+void latency_get_summary(latency_stage_e stage, latency_summary_s *summary);
+
+/**
+ * @brief Returns printable name of stage.
+ */
+const char *latency_stage_name(latency_stage_e stage);
+
+/**
+ * @brief Logs summaries of all stages.
+ */
+void latency_dump(void);
+
+/**
+ * @brief Clears all histograms.
+ */
+void latency_reset(void);
+
+#endif /* INC_LATENCY_H_ */
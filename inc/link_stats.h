@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_LINK_STATS_H_
+#define INC_LINK_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Link quality of a controller session.
+ */
+typedef struct link_stats_summary {
+	int64_t rtt_ns;         /** Smoothed round trip time, -1 until first sample */
+	int64_t rtt_var_ns;     /** Round trip time variation, -1 until first sample */
+	int64_t jitter_ns;      /** Inter-arrival jitter of COMMAND messages */
+	uint64_t received;      /** Messages received in order or late */
+	uint64_t lost;          /** Messages missing from serial sequence */
+	uint64_t reordered;     /** Messages received after later ones */
+	unsigned int loss_ppm;  /** Lost messages per million expected */
+} link_stats_summary_s;
+
+/**
+ * @brief Link statistics estimator.
+ *
+ * RTT is estimated like TCP retransmission timer (RFC 6298), jitter
+ * like RTP interarrival jitter (RFC 3550) from sender timestamps, loss
+ * and reordering from gaps in serial numbers of received messages.
+ */
+typedef struct link_stats {
+	bool synced;              /** At least one serial was seen */
+	int64_t base_serial;      /** First serial of the current sequence */
+	int64_t max_serial;       /** Highest serial of the current sequence */
+	uint64_t base_lost;       /** Losses of sequences before resync */
+	uint64_t base_expected;   /** Expected messages of sequences before resync */
+	uint64_t base_received;   /** Received messages of sequences before resync */
+	uint64_t received;        /** Messages received in the current sequence */
+	uint64_t reordered;
+	bool has_rtt;
+	int64_t rtt_ns;
+	int64_t rtt_var_ns;
+	bool has_arrival;
+	int64_t last_arrival_ns;  /** Local arrival of the last COMMAND */
+	int64_t last_timestamp;   /** Sender timestamp of the last COMMAND in ms */
+	int64_t jitter_ns;
+} link_stats_t;
+
+/**
+ * @brief Resets statistics, e.g. when new session starts.
+ *
+ * @param[in] stats stats object.
+ */
+void link_stats_init(link_stats_t *stats);
+
+/**
+ * @brief Accounts received message.
+ *
+ * @param[in] stats stats object.
+ * @param[in] serial serial number of the message.
+ *
+ * @return false if the serial was already passed or is out of sequence,
+ * true otherwise.
+ */
+bool link_stats_received(link_stats_t *stats, int64_t serial);
+
+/**
+ * @brief Accounts arrival of COMMAND message for jitter estimation.
+ *
+ * @param[in] stats stats object.
+ * @param[in] timestamp sender timestamp of the message in ms.
+ * @param[in] now_ns local monotonic arrival time.
+ */
+void link_stats_command_arrived(link_stats_t *stats, int64_t timestamp, int64_t now_ns);
+
+/**
+ * @brief Adds round trip time sample.
+ *
+ * @param[in] stats stats object.
+ * @param[in] rtt_ns measured round trip time.
+ */
+void link_stats_rtt_sample(link_stats_t *stats, int64_t rtt_ns);
+
+/**
+ * @brief Gets current statistics.
+ *
+ * @param[in] stats stats object.
+ * @param[out] summary statistics.
+ */
+void link_stats_get_summary(const link_stats_t *stats, link_stats_summary_s *summary);
+
+#endif /* INC_LINK_STATS_H_ */
@@ -19,6 +19,7 @@
 #ifndef __CAR_APP_LOG_H__
 #define __CAR_APP_LOG_H__
 
+#include <stdint.h>
 #include <dlog.h>
 
 #ifdef  LOG_TAG
@@ -26,22 +27,60 @@
 #endif
 #define LOG_TAG "CAR_APP"
 
+/*
+ * Messages below LOG_MIN_LEVEL are compiled out, arguments are not
+ * evaluated. Build with e.g. -DLOG_MIN_LEVEL=DLOG_INFO for production.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL DLOG_DEBUG
+#endif
+
+/* runtime level, checked before any formatting */
+extern log_priority log_level;
+
+#define LOG_ENABLED(prio) ((prio) >= LOG_MIN_LEVEL && (prio) >= log_level)
+
+#define __LOG(prio, fmt, arg...) do { \
+	if (LOG_ENABLED(prio)) { \
+		static log_site_s __log_site; \
+		log_print_site(&__log_site, prio, LOG_TAG, "[%s:%d] " fmt "\n", __func__, __LINE__, ##arg); \
+	} \
+} while (0)
+
+/* at most per_sec messages a second from call site, the next one reports how many were skipped */
+#define __LOG_RATELIMITED(prio, per_sec, fmt, arg...) do { \
+	static log_ratelimit_s __ratelimit; \
+	unsigned int __suppressed; \
+	static log_site_s __log_site, __log_site_suppressed; \
+	if (LOG_ENABLED(prio) && log_ratelimit_pass(&__ratelimit, (per_sec), &__suppressed)) { \
+		if (__suppressed) \
+			log_print_site(&__log_site_suppressed, prio, LOG_TAG, "[%s:%d] " fmt " (%u suppressed)\n", __func__, __LINE__, ##arg, __suppressed); \
+		else \
+			log_print_site(&__log_site, prio, LOG_TAG, "[%s:%d] " fmt "\n", __func__, __LINE__, ##arg); \
+	} \
+} while (0)
+
 #if !defined(_D)
-#define _D(fmt, arg...) log_print(DLOG_DEBUG, LOG_TAG, "[%s:%d] " fmt "\n", __func__, __LINE__, ##arg)
+#define _D(fmt, arg...) __LOG(DLOG_DEBUG, fmt, ##arg)
 #endif
 
 #if !defined(_I)
-#define _I(fmt, arg...) log_print(DLOG_INFO, LOG_TAG, "[%s:%d] " fmt "\n", __func__, __LINE__, ##arg)
+#define _I(fmt, arg...) __LOG(DLOG_INFO, fmt, ##arg)
 #endif
 
 #if !defined(_W)
-#define _W(fmt, arg...) log_print(DLOG_WARN, LOG_TAG, "[%s:%d] " fmt "\n", __func__, __LINE__, ##arg)
+#define _W(fmt, arg...) __LOG(DLOG_WARN, fmt, ##arg)
 #endif
 
 #if !defined(_E)
-#define _E(fmt, arg...) log_print(DLOG_ERROR, LOG_TAG, "[%s:%d] " fmt "\n", __func__, __LINE__, ##arg)
+#define _E(fmt, arg...) __LOG(DLOG_ERROR, fmt, ##arg)
 #endif
 
+#define _D_RL(per_sec, fmt, arg...) __LOG_RATELIMITED(DLOG_DEBUG, per_sec, fmt, ##arg)
+#define _I_RL(per_sec, fmt, arg...) __LOG_RATELIMITED(DLOG_INFO, per_sec, fmt, ##arg)
+#define _W_RL(per_sec, fmt, arg...) __LOG_RATELIMITED(DLOG_WARN, per_sec, fmt, ##arg)
+#define _E_RL(per_sec, fmt, arg...) __LOG_RATELIMITED(DLOG_ERROR, per_sec, fmt, ##arg)
+
 #define retvm_if(expr, val, fmt, arg...) do { \
 	if (expr) { \
 		_E(fmt, ##arg); \
@@ -97,10 +136,47 @@ typedef enum {
 	LOG_TYPE_DLOG = 0,
 	LOG_TYPE_FILE,
 	LOG_TYPE_ALL,
+	LOG_TYPE_BINARY, /* records to memory mapped log.bin, warnings and errors also to dlog */
 } log_type;
 
+/* call site of log macros, registered once in binary log */
+typedef struct _log_site {
+	uint32_t id;
+	struct _log_site *next;
+} log_site_s;
+
+typedef struct {
+	long long window_start; /* start of current one second window, ms */
+	unsigned int passed;     /* messages passed in current window */
+	unsigned int suppressed; /* messages suppressed since last passed one */
+} log_ratelimit_s;
+
+typedef struct {
+	unsigned long long written; /* records written by the background thread */
+	unsigned long long dropped; /* records dropped because ring buffer was full */
+} log_async_stats_s;
+
 int log_print(log_priority prio, const char *tag, const char *fmt, ...);
+int log_print_site(log_site_s *site, log_priority prio, const char *tag, const char *fmt, ...);
 int log_type_set(log_type type);
+void log_level_set(log_priority prio);
+
+/*
+ * Returns 1 if message from the call site owning ratelimit may be printed,
+ * suppressed is set to number of messages skipped since the previous one.
+ * Not synchronized, counts are approximate if call site is shared by threads.
+ */
+int log_ratelimit_pass(log_ratelimit_s *ratelimit, unsigned int per_sec, unsigned int *suppressed);
 void log_file_close(void);
 
+/*
+ * Async mode: log_print only formats the message into a lock-free ring
+ * buffer and returns, a background thread writes records to the log type
+ * sinks. When the buffer is full records are dropped and counted, callers
+ * never block. capacity is number of records, power of 2, 0 for default.
+ */
+int log_async_start(unsigned int capacity);
+void log_async_stop(void);
+void log_async_get_stats(log_async_stats_s *stats);
+
 #endif /* __CAR_APP_LOG_H__ */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CAR_APP_LOG_BINARY_H__
+#define __CAR_APP_LOG_BINARY_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/*
+ * Binary log file, memory mapped:
+ *
+ *   log_binary_header_s
+ *   call site definitions, LOG_BINARY_SITES_SIZE bytes, append only
+ *   LOG_BINARY_SLOT_COUNT fixed size record slots, used as a ring
+ *
+ * Call site definition is written once per call site and carries format
+ * string, function and line. Records keep only call site id, timestamp
+ * and raw arguments, text is rendered offline by host/tools/blog_decode.
+ */
+
+#define LOG_BINARY_MAGIC "CARBLOG"
+#define LOG_BINARY_VERSION 1
+#define LOG_BINARY_SITES_SIZE (64 * 1024)
+#define LOG_BINARY_SLOT_SIZE 128
+#define LOG_BINARY_SLOT_COUNT 32768
+#define LOG_BINARY_FILE_SIZE (sizeof(log_binary_header_s) + LOG_BINARY_SITES_SIZE \
+	+ (size_t)LOG_BINARY_SLOT_SIZE * LOG_BINARY_SLOT_COUNT)
+
+typedef struct log_binary_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t slot_size;
+	uint32_t slot_count;
+	uint32_t sites_size;
+	uint32_t sites_used;  /* bytes of site region in use */
+	uint32_t site_count;  /* last assigned site id */
+	uint64_t next_seq;    /* sequence number of next record */
+} log_binary_header_s;
+
+/* size is written last, 0 ends the list */
+typedef struct log_binary_site {
+	uint32_t size;        /* whole entry, strings included, 8 byte aligned */
+	uint16_t id;
+	uint8_t prio;
+	uint8_t reserved;
+	uint32_t line;
+	/* tag, function and format follow, each NUL terminated */
+	char strings[];
+} log_binary_site_s;
+
+/* seq is written last, 0 marks empty or torn slot */
+typedef struct log_binary_slot {
+	uint64_t seq;         /* record sequence number + 1 */
+	int64_t timestamp;    /* nanoseconds since Epoch */
+	uint16_t site;
+	uint16_t length;      /* bytes of payload in use */
+	uint8_t truncated;    /* arguments did not fit */
+	uint8_t reserved[3];
+	uint8_t payload[LOG_BINARY_SLOT_SIZE - 24];
+} log_binary_slot_s;
+
+typedef enum {
+	LOG_BINARY_ARG_NONE,     /* %% */
+	LOG_BINARY_ARG_INT,      /* int and shorter, %c included */
+	LOG_BINARY_ARG_LONG,
+	LOG_BINARY_ARG_LLONG,
+	LOG_BINARY_ARG_SIZE,     /* size_t, intmax_t, ptrdiff_t */
+	LOG_BINARY_ARG_DOUBLE,
+	LOG_BINARY_ARG_LDOUBLE,
+	LOG_BINARY_ARG_STRING,
+	LOG_BINARY_ARG_POINTER,
+} log_binary_arg_e;
+
+typedef struct log_binary_conversion {
+	size_t start;            /* offset of '%' */
+	size_t end;              /* offset past conversion character */
+	int star_width;          /* width taken from int argument */
+	int star_precision;      /* precision taken from int argument */
+	int is_unsigned;
+	log_binary_arg_e type;
+} log_binary_conversion_s;
+
+/*
+ * Finds next printf conversion in fmt at or after *pos.
+ * Returns 0 and advances *pos past it, -1 when there is none.
+ */
+int log_binary_next_conversion(const char *fmt, size_t *pos, log_binary_conversion_s *conv);
+
+/*
+ * Packs arguments described by fmt into payload.
+ * Returns number of bytes used, *truncated is set when not all arguments fit.
+ */
+size_t log_binary_pack(uint8_t *payload, size_t size, const char *fmt, size_t fmt_pos,
+	va_list ap, int *truncated);
+
+#endif /* __CAR_APP_LOG_BINARY_H__ */
@@ -14,12 +14,17 @@
  * limitations under the License.
  */
 
+
 #ifndef _CLOCK_MONOTONIC_H
 #define _CLOCK_MONOTONIC_H
 
 #include <time.h>
+#include <stdint.h>
 #include <stdbool.h>
 
+#define CLOCK_NS_PER_MS 1000000LL
+#define CLOCK_NS_PER_SEC 1000000000LL
+
 /**
  * @brief Check if platform supports all required clock types
  *
@@ -34,9 +39,13 @@ bool clock_is_supported();
  * call @clock_is_supported beforehead to validate if platform
  * supports all clock types.
  *
- * @return: seconds since unspecified time point.
+ * @note when built with CLOCK_MONOTONIC_USE_RAW defined the func reads
+ * CLOCK_MONOTONIC_RAW, which is not slewed by NTP, but may not be
+ * served by vDSO on older kernels.
+ *
+ * @return: nanoseconds since unspecified time point.
  */
-float clock_monotonic_get();
+int64_t clock_monotonic_ns_get();
 
 /**
  * @brief Gets current time using realtime clock
@@ -45,8 +54,17 @@ float clock_monotonic_get();
  * call @clock_is_supported beforehead to validate if platform
  * supports all clock types.
  *
- * @return: number of seconds since Epoch
+ * @return: number of nanoseconds since Epoch
+ */
+int64_t clock_realtime_ns_get();
+
+/**
+ * @brief Gets current time using realtime clock
+ *
+ * @note see @clock_realtime_ns_get
+ *
+ * @return: number of milliseconds since Epoch
  */
-time_t clock_realtime_get();
+int64_t clock_realtime_ms_get();
 
 #endif
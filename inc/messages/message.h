@@ -19,22 +19,44 @@
 
 #include "messages/writer.h"
 #include "messages/reader.h"
+#include "messages/message_schema.h"
+#include "endpoint.h"
+
+#define MESSAGE_TYPE_ENUM(TYPE, name, FIELDS) MESSAGE_##TYPE,
 
 /**
- * @brief message types
+ * @brief message types, see MESSAGE_SCHEMA for description
  */
 typedef enum message_type {
 	MESSAGE_NONE,
-	MESSAGE_CONNECT,          /** Connection request */
-	MESSAGE_CONNECT_ACCEPTED, /** Connection accepted reply */
-	MESSAGE_CONNECT_REFUSED,  /** Connection refused reply */
-	MESSAGE_KEEP_ALIVE,       /** Keep alive request */
-	MESSAGE_ACK,              /** Message delivery confirmation */
-	MESSAGE_COMMAND,          /** Message with command data */
-	MESSAGE_BYE               /** Connection end request */
+	MESSAGE_SCHEMA(MESSAGE_TYPE_ENUM)
+	MESSAGE_TYPE_MAX
 } message_type_e;
 
-#define IP_ADDRESS_LEN 15
+#undef MESSAGE_TYPE_ENUM
+
+/**
+ * @brief wire format versions
+ *
+ * Versions are told apart by the first byte of a datagram, which is
+ * always 0 in v1 and has MESSAGE_WIRE_V2_MARK bit set in v2.
+ */
+typedef enum message_wire_version {
+	MESSAGE_WIRE_V1 = 1, /** int32 type prefix, 20-byte header, big endian int32/int64 fields */
+	MESSAGE_WIRE_V2 = 2, /** 1-byte type, varint header and integers, int16 command values */
+} message_wire_version_e;
+
+#define MESSAGE_WIRE_VERSION_MAX MESSAGE_WIRE_V2
+
+/**
+ * @brief Role of a controller session, requested in CONNECT and granted
+ * in CONNECT_ACCEPTED.
+ */
+typedef enum message_role {
+	MESSAGE_ROLE_DRIVER,   /** Drives the car, only one at time */
+	MESSAGE_ROLE_OBSERVER  /** Receives telemetry, its commands are ignored */
+} message_role_e;
+#define MESSAGE_WIRE_V2_MARK 0x80
 
 typedef struct message message_t;
 
@@ -43,17 +65,10 @@ typedef struct message message_t;
  */
 struct message {
 	int64_t serial;
-	int64_t timestamp;
+	int64_t timestamp; /** Milliseconds since Epoch */
 	int32_t type;
-	int sender_port;
-	int receiver_port;
-	char sender_ip[IP_ADDRESS_LEN+1];
-	char receiver_ip[IP_ADDRESS_LEN+1];
-	struct {
-		int (*deserialize)(message_t *msg, reader_t *reader);
-		int (*serialize)(message_t *msg, writer_t *writer);
-		void (*destroy)(message_t *msg);
-	} vtable;
+	endpoint_t sender;
+	endpoint_t receiver;
 };
 
 /**
@@ -61,8 +76,8 @@ struct message {
  *
  * @param[in] message message object.
  *
- * @note this function is implementing polymorphic behaviour of
- * message_t object. The the destroy is made via vtable->destroy pointer.
+ * @note messages generated from MESSAGE_SCHEMA do not own any
+ * resources, the function is kept for symmetry with init functions.
  */
 void message_destroy(message_t *message);
 
@@ -74,8 +89,8 @@ void message_destroy(message_t *message);
  *
  * @return 0 on success, other value on failure.
  *
- * @note this function is implementing polymorphic behaviour of
- * message_t object. The serialization is made via vtable->serialize pointer.
+ * @note this function dispatches on message type to encoder
+ * generated from MESSAGE_SCHEMA.
  */
 int message_serialize(message_t *message, writer_t *writer);
 
@@ -87,67 +102,90 @@ int message_serialize(message_t *message, writer_t *writer);
  *
  * @return 0 on success, other value on failure.
  *
- * @note this function is implementing polymorphic behaviour of
- * message_t object. The deserialization is made via vtable->serialize pointer.
+ * @note this function dispatches on message type to decoder
+ * generated from MESSAGE_SCHEMA, so @message has to be initialized
+ * for the type being read.
  */
 int message_deserialize(message_t *message, reader_t *reader);
 
+/**
+ * @brief Encodes whole datagram of the message, including type prefix.
+ *
+ * @param[in] message message object.
+ * @param[in] writer writer object.
+ * @param[in] version wire format version.
+ *
+ * @return 0 on success, other value on failure.
+ */
+int message_encode(message_t *message, writer_t *writer, message_wire_version_e version);
+
+/**
+ * @brief Decodes whole datagram of the message, including type prefix.
+ *
+ * @param[in] message message object.
+ * @param[in] reader reader object.
+ *
+ * @return 0 on success, other value on failure.
+ *
+ * @note wire format version is detected from the datagram, its type
+ * has to match the type @message was initialized for.
+ */
+int message_decode(message_t *message, reader_t *reader);
+
 /**
  * @brief Get reciever of the message
  *
  * @param[in] message message object.
- * @param[out] ip address of reciever.
- * @param[out] port port of the reciever.
  *
- * @note if reciever is not set the @ip will be empty string.
+ * @return reciever endpoint.
+ *
+ * @note if reciever is not set the endpoint will be zeroed.
  */
-void message_get_receiver(message_t *messsage, const char **ip, int *port);
+const endpoint_t *message_get_receiver(message_t *messsage);
 
 /**
  * @brief Set reciever of the message.
  *
  * @param[in] message message object.
- * @param[in] ip address of reciever.
- * @param[in] port port of the reciever.
+ * @param[in] receiver reciever endpoint.
  */
-void message_set_receiver(message_t *messsage, const char *ip, int port);
+void message_set_receiver(message_t *messsage, const endpoint_t *receiver);
 
 /**
  * @brief Get sender of the message.
  *
  * @param[in] message message object.
- * @param[out] ip address of sender.
- * @param[out] port port of the sender.
  *
- * @note if sender is not set the @ip will be empty string.
+ * @return sender endpoint.
+ *
+ * @note if sender is not set the endpoint will be zeroed.
  */
-void message_get_sender(message_t *message, const char **ip, int *port);
+const endpoint_t *message_get_sender(message_t *message);
 
 /**
  * @brief Set sender of the message.
  *
  * @param[in] message message object.
- * @param[in] ip address of sender.
- * @param[in] port port of the sender.
+ * @param[in] sender sender endpoint.
  */
-void message_set_sender(message_t *message, const char *ip, int port);
+void message_set_sender(message_t *message, const endpoint_t *sender);
 
 /**
  * @brief Get timestamp of the message.
  *
  * @param[in] message message object.
  *
- * @return Unix timestamp.
+ * @return Milliseconds since Epoch.
  */
-time_t message_get_timestamp(message_t *messsage);
+int64_t message_get_timestamp(message_t *messsage);
 
 /**
  * @brief Set timestamp of the message.
  *
  * @param[in] message message object.
- * @param[in] time Unix timestamp.
+ * @param[in] time Milliseconds since Epoch.
  */
-void message_set_timestamp(message_t *messsage, time_t time);
+void message_set_timestamp(message_t *messsage, int64_t time);
 
 /**
  * @brief Get type of the message.
@@ -189,6 +227,24 @@ int64_t message_get_serial(message_t *message);
  */
 void message_base_init(message_t *msg);
 
+/**
+ * @brief Assigns next serial number to initialized base message object.
+ *
+ * @param[in] message message object.
+ *
+ * @note unlike @message_base_init, other fields are left intact, so
+ * a message can be reused without building it from scratch.
+ */
+void message_base_renew(message_t *msg);
+
+/**
+ * @brief Takes next serial number, the same sequence is used by
+ * @message_base_init.
+ *
+ * @return serial number.
+ */
+int64_t message_next_serial();
+
 /**
  * @brief Destroys base message object.
  *
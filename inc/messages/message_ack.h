@@ -17,22 +17,12 @@
 #ifndef MESSAGE_ACK_H
 #define MESSAGE_ACK_H
 
-#include "messages/message.h"
+#include "messages/message_types.h"
 
-/**
- * @brief Ack message data
- */
-typedef struct message_ack {
-	message_t base;       /** Base class */
-	int64_t ack_serial;   /** The serial of message which reception is confirmed */
-} message_ack_t;
-
-/**
- * @brief Initializes message_ack_t object.
- *
- * @param[in] message ack message.
+/*
+ * message_ack_t with its init, destroy, serialize and deserialize
+ * functions is generated from MESSAGE_SCHEMA, see message_types.h.
  */
-void message_ack_init(message_ack_t *message);
 
 /**
  * @brief initializes message_ack_t message form other message.
@@ -53,30 +43,11 @@ void message_ack_init_from_request(message_ack_t *message, message_t *request);
 int64_t message_ack_get_ack_serial(message_ack_t *message);
 
 /**
- * @brief Destroys message_ack_t object.
- *
- * @param[in] message ack message.
- */
-void message_ack_destroy(message_ack_t *message);
-
-/**
- * @brief Deserializes message_ack_t from reader's buffer.
+ * @brief Sets serial number of confirmed message.
  *
  * @param[in] message ack message.
- * @param[in] reader reader object.
- *
- * @return 0 on success, other value on failure.
- */
-int message_ack_deserialize(message_ack_t *message, reader_t *reader);
-
-/**
- * @brief Serializes message_ack_t into writer's buffer.
- *
- * @param[in] message message object.
- * @param[in] writer writer object.
- *
- * @return 0 on success, other value on failure.
+ * @param[in] ack_serial the serial number.
  */
-int message_ack_serialize(message_ack_t *message, writer_t *writer);
+void message_ack_set_ack_serial(message_ack_t *message, int64_t ack_serial);
 
 #endif /* end of include guard: MESSAGE_ACK_H */
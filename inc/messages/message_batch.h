@@ -0,0 +1,43 @@
+/*
+* Copyright (c) 2018 Samsung Electronics Co., Ltd.
+*
+* Licensed under the Flora License, Version 1.1 (the License);
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://floralicense.org/license/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef MESSAGE_BATCH_H
+#define MESSAGE_BATCH_H
+
+#include "messages/message_types.h"
+
+/*
+ * message_batch_t with its init, destroy, serialize and deserialize
+ * functions is generated from MESSAGE_SCHEMA, see message_types.h.
+ */
+
+/**
+ * @brief Appends message to the batch.
+ *
+ * @param[in] message batch message.
+ * @param[in] entries writer holding entries of the @message.
+ * @param[in] sub message to be appended, it can not be a batch.
+ * @param[in] version wire format version used to encode @sub.
+ *
+ * @return 0 on success, other value on failure.
+ *
+ * @note entries of the @message point into the @entries buffer, so
+ * the writer has to be empty before first append, outlive @message
+ * and can not be used for anything else between appends.
+ */
+int message_batch_append(message_batch_t *message, writer_t *entries, message_t *sub, message_wire_version_e version);
+
+#endif /* end of include guard: MESSAGE_BATCH_H */
@@ -0,0 +1,695 @@
+/*
+* Copyright (c) 2018 Samsung Electronics Co., Ltd.
+*
+* Licensed under the Flora License, Version 1.1 (the License);
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://floralicense.org/license/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef MESSAGE_CODEC_H
+#define MESSAGE_CODEC_H
+
+#include <stdint.h>
+
+#include "messages/message_types.h"
+#include "messages/macros.h"
+
+/*
+ * Field codecs, one triple per schema field kind and wire version:
+ * - message_codec_write[_v2]_<kind> appends value to writer,
+ * - message_codec_read[_v2]_<kind> reads value from reader,
+ * - message_codec_skip[_v2]_<kind> checks that reader holds valid value and skips it.
+ * All of them return 0 on success, other value on failure.
+ */
+
+static inline int message_codec_write_int32(writer_t *writer, const message_field_int32_t *value)
+{
+	return writer_write_int32(writer, *value);
+}
+
+static inline int message_codec_read_int32(reader_t *reader, message_field_int32_t *value)
+{
+	return reader_read_int32(reader, value);
+}
+
+static inline int message_codec_skip_int32(reader_t *reader)
+{
+	return reader_take(reader, sizeof(int32_t)) ? 0 : -1;
+}
+
+static inline int message_codec_write_int64(writer_t *writer, const message_field_int64_t *value)
+{
+	return writer_write_int64(writer, *value);
+}
+
+static inline int message_codec_read_int64(reader_t *reader, message_field_int64_t *value)
+{
+	return reader_read_int64(reader, value);
+}
+
+static inline int message_codec_skip_int64(reader_t *reader)
+{
+	return reader_take(reader, sizeof(int64_t)) ? 0 : -1;
+}
+
+static inline int message_codec_write_bool(writer_t *writer, const message_field_bool_t *value)
+{
+	return writer_write_bool(writer, *value);
+}
+
+static inline int message_codec_read_bool(reader_t *reader, message_field_bool_t *value)
+{
+	return reader_read_bool(reader, value);
+}
+
+static inline int message_codec_skip_bool(reader_t *reader)
+{
+	return reader_take(reader, sizeof(char)) ? 0 : -1;
+}
+
+/* command is its type followed by 0, 2 or 4 int32 values depending on it */
+static inline int message_codec_command_values(int32_t type)
+{
+	switch (type) {
+	case COMMAND_TYPE_NONE:
+		return 0;
+	case COMMAND_TYPE_DRIVE:
+	case COMMAND_TYPE_CAMERA:
+		return 2;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		return 4;
+	default:
+		return -1;
+	}
+}
+
+static inline int message_codec_write_command(writer_t *writer, const message_field_command_t *value)
+{
+	int err = writer_write_int32(writer, value->type);
+
+	switch (value->type) {
+	case COMMAND_TYPE_NONE:
+		return err;
+	case COMMAND_TYPE_DRIVE:
+		err |= writer_write_int32(writer, value->data.steering.speed);
+		err |= writer_write_int32(writer, value->data.steering.direction);
+		return err;
+	case COMMAND_TYPE_CAMERA:
+		err |= writer_write_int32(writer, value->data.camera_position.camera_elevation);
+		err |= writer_write_int32(writer, value->data.camera_position.camera_azimuth);
+		return err;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		err |= writer_write_int32(writer, value->data.steering_and_camera.speed);
+		err |= writer_write_int32(writer, value->data.steering_and_camera.direction);
+		err |= writer_write_int32(writer, value->data.steering_and_camera.camera_elevation);
+		err |= writer_write_int32(writer, value->data.steering_and_camera.camera_azimuth);
+		return err;
+	default:
+		return -1;
+	}
+}
+
+static inline int message_codec_read_command(reader_t *reader, message_field_command_t *value)
+{
+	const char *data;
+	int32_t type, v[4];
+	int count, i;
+
+	if (reader_read_int32(reader, &type))
+		return -1;
+
+	count = message_codec_command_values(type);
+	if (count < 0)
+		return -1;
+
+	/* all values are checked at once, then loaded without checks */
+	data = reader_take(reader, count * sizeof(int32_t));
+	if (!data)
+		return -1;
+	for (i = 0; i < count; i++)
+		v[i] = reader_load_be32(data + i * sizeof(int32_t));
+
+	value->type = type;
+	switch (type) {
+	case COMMAND_TYPE_DRIVE:
+		value->data.steering.speed = v[0];
+		value->data.steering.direction = v[1];
+		break;
+	case COMMAND_TYPE_CAMERA:
+		value->data.camera_position.camera_elevation = v[0];
+		value->data.camera_position.camera_azimuth = v[1];
+		break;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		value->data.steering_and_camera.speed = v[0];
+		value->data.steering_and_camera.direction = v[1];
+		value->data.steering_and_camera.camera_elevation = v[2];
+		value->data.steering_and_camera.camera_azimuth = v[3];
+		break;
+	}
+
+	return 0;
+}
+
+static inline int message_codec_skip_command(reader_t *reader)
+{
+	int32_t type;
+	int count;
+
+	if (reader_read_int32(reader, &type))
+		return -1;
+
+	count = message_codec_command_values(type);
+	if (count < 0 || !reader_take(reader, count * sizeof(int32_t)))
+		return -1;
+
+	return 0;
+}
+
+/* version is optional in v1, it was appended to CONNECT messages with v2 */
+static inline int message_codec_write_version(writer_t *writer, const message_field_version_t *value)
+{
+	return writer_write_int32(writer, *value);
+}
+
+static inline int message_codec_read_version(reader_t *reader, message_field_version_t *value)
+{
+	int32_t version;
+
+	if (reader->offset == reader->len) {
+		*value = MESSAGE_WIRE_V1;
+		return 0;
+	}
+
+	if (reader_read_int32(reader, &version))
+		return -1;
+
+	*value = version;
+	return 0;
+}
+
+static inline int message_codec_skip_version(reader_t *reader)
+{
+	if (reader->offset == reader->len)
+		return 0;
+	return message_codec_skip_int32(reader);
+}
+
+/* role is optional in v1 as well, controllers without it are drivers */
+static inline int message_codec_write_role(writer_t *writer, const message_field_role_t *value)
+{
+	return writer_write_int32(writer, *value);
+}
+
+static inline int message_codec_read_role(reader_t *reader, message_field_role_t *value)
+{
+	int32_t role;
+
+	if (reader->offset == reader->len) {
+		*value = MESSAGE_ROLE_DRIVER;
+		return 0;
+	}
+
+	if (reader_read_int32(reader, &role))
+		return -1;
+
+	*value = role;
+	return 0;
+}
+
+static inline int message_codec_skip_role(reader_t *reader)
+{
+	if (reader->offset == reader->len)
+		return 0;
+	return message_codec_skip_int32(reader);
+}
+
+/*
+ * v2 field codecs: signed integers are zigzag mapped to varints, command
+ * is 1-byte type followed by int16 values, version is a single byte.
+ */
+
+static inline uint64_t message_codec_zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t message_codec_unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline int message_codec_write_v2_int64(writer_t *writer, const message_field_int64_t *value)
+{
+	return writer_write_varint(writer, message_codec_zigzag(*value));
+}
+
+static inline int message_codec_read_v2_int64(reader_t *reader, message_field_int64_t *value)
+{
+	uint64_t v;
+
+	if (reader_read_varint(reader, &v))
+		return -1;
+
+	*value = message_codec_unzigzag(v);
+	return 0;
+}
+
+static inline int message_codec_skip_v2_int64(reader_t *reader)
+{
+	message_field_int64_t value;
+	return message_codec_read_v2_int64(reader, &value);
+}
+
+static inline int message_codec_write_v2_int32(writer_t *writer, const message_field_int32_t *value)
+{
+	return writer_write_varint(writer, message_codec_zigzag(*value));
+}
+
+static inline int message_codec_read_v2_int32(reader_t *reader, message_field_int32_t *value)
+{
+	int64_t v;
+
+	if (message_codec_read_v2_int64(reader, &v) || v < INT32_MIN || v > INT32_MAX)
+		return -1;
+
+	*value = v;
+	return 0;
+}
+
+static inline int message_codec_skip_v2_int32(reader_t *reader)
+{
+	message_field_int32_t value;
+	return message_codec_read_v2_int32(reader, &value);
+}
+
+static inline int message_codec_write_v2_bool(writer_t *writer, const message_field_bool_t *value)
+{
+	return message_codec_write_bool(writer, value);
+}
+
+static inline int message_codec_read_v2_bool(reader_t *reader, message_field_bool_t *value)
+{
+	return message_codec_read_bool(reader, value);
+}
+
+static inline int message_codec_skip_v2_bool(reader_t *reader)
+{
+	return message_codec_skip_bool(reader);
+}
+
+static inline int message_codec_write_v2_command_value(writer_t *writer, int value)
+{
+	if (value < INT16_MIN || value > INT16_MAX)
+		return -1;
+	return writer_write_int16(writer, value);
+}
+
+static inline int message_codec_write_v2_command(writer_t *writer, const message_field_command_t *value)
+{
+	int err = writer_write_char(writer, value->type);
+
+	switch (value->type) {
+	case COMMAND_TYPE_NONE:
+		return err;
+	case COMMAND_TYPE_DRIVE:
+		err |= message_codec_write_v2_command_value(writer, value->data.steering.speed);
+		err |= message_codec_write_v2_command_value(writer, value->data.steering.direction);
+		return err;
+	case COMMAND_TYPE_CAMERA:
+		err |= message_codec_write_v2_command_value(writer, value->data.camera_position.camera_elevation);
+		err |= message_codec_write_v2_command_value(writer, value->data.camera_position.camera_azimuth);
+		return err;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		err |= message_codec_write_v2_command_value(writer, value->data.steering_and_camera.speed);
+		err |= message_codec_write_v2_command_value(writer, value->data.steering_and_camera.direction);
+		err |= message_codec_write_v2_command_value(writer, value->data.steering_and_camera.camera_elevation);
+		err |= message_codec_write_v2_command_value(writer, value->data.steering_and_camera.camera_azimuth);
+		return err;
+	default:
+		return -1;
+	}
+}
+
+static inline int message_codec_read_v2_command(reader_t *reader, message_field_command_t *value)
+{
+	const char *data;
+	int16_t v[4];
+	char type;
+	int count, i;
+
+	if (reader_read_char(reader, &type))
+		return -1;
+
+	count = message_codec_command_values(type);
+	if (count < 0)
+		return -1;
+
+	data = reader_take(reader, count * sizeof(int16_t));
+	if (!data)
+		return -1;
+	for (i = 0; i < count; i++)
+		v[i] = reader_load_be16(data + i * sizeof(int16_t));
+
+	value->type = type;
+	switch (type) {
+	case COMMAND_TYPE_DRIVE:
+		value->data.steering.speed = v[0];
+		value->data.steering.direction = v[1];
+		break;
+	case COMMAND_TYPE_CAMERA:
+		value->data.camera_position.camera_elevation = v[0];
+		value->data.camera_position.camera_azimuth = v[1];
+		break;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		value->data.steering_and_camera.speed = v[0];
+		value->data.steering_and_camera.direction = v[1];
+		value->data.steering_and_camera.camera_elevation = v[2];
+		value->data.steering_and_camera.camera_azimuth = v[3];
+		break;
+	}
+
+	return 0;
+}
+
+static inline int message_codec_skip_v2_command(reader_t *reader)
+{
+	char type;
+	int count;
+
+	if (reader_read_char(reader, &type))
+		return -1;
+
+	count = message_codec_command_values(type);
+	if (count < 0 || !reader_take(reader, count * sizeof(int16_t)))
+		return -1;
+
+	return 0;
+}
+
+static inline int message_codec_write_v2_version(writer_t *writer, const message_field_version_t *value)
+{
+	return writer_write_char(writer, *value);
+}
+
+static inline int message_codec_read_v2_version(reader_t *reader, message_field_version_t *value)
+{
+	char version;
+
+	if (reader_read_char(reader, &version))
+		return -1;
+
+	*value = (unsigned char)version;
+	return 0;
+}
+
+static inline int message_codec_skip_v2_version(reader_t *reader)
+{
+	return message_codec_skip_bool(reader);
+}
+
+static inline int message_codec_write_v2_role(writer_t *writer, const message_field_role_t *value)
+{
+	return writer_write_char(writer, *value);
+}
+
+static inline int message_codec_read_v2_role(reader_t *reader, message_field_role_t *value)
+{
+	char role;
+
+	if (reader_read_char(reader, &role))
+		return -1;
+
+	*value = (unsigned char)role;
+	return 0;
+}
+
+static inline int message_codec_skip_v2_role(reader_t *reader)
+{
+	return message_codec_skip_bool(reader);
+}
+
+/*
+ * batch is number of entries followed by the entries, each of them
+ * prefixed with its length as big endian uint16. Count is int32 in v1
+ * and varint in v2, entries are the same in both versions.
+ */
+
+static inline int message_codec_skip_batch_entries(reader_t *reader, int32_t count)
+{
+	int16_t length;
+	int32_t i;
+
+	if (count < 0)
+		return -1;
+
+	for (i = 0; i < count; i++) {
+		if (reader_read_int16(reader, &length))
+			return -1;
+		if (!reader_take(reader, (uint16_t)length))
+			return -1;
+	}
+
+	return 0;
+}
+
+static inline int message_codec_read_batch_entries(reader_t *reader, int32_t count, message_field_batch_t *value)
+{
+	size_t start = reader->offset;
+
+	if (message_codec_skip_batch_entries(reader, count))
+		return -1;
+
+	value->data = reader->data + start;
+	value->size = reader->offset - start;
+	value->count = count;
+	return 0;
+}
+
+static inline int message_codec_write_batch(writer_t *writer, const message_field_batch_t *value)
+{
+	int err = writer_write_int32(writer, value->count);
+	err |= writer_write_bytes(writer, value->data, value->size);
+	return err;
+}
+
+static inline int message_codec_read_batch(reader_t *reader, message_field_batch_t *value)
+{
+	int32_t count;
+
+	if (reader_read_int32(reader, &count))
+		return -1;
+	return message_codec_read_batch_entries(reader, count, value);
+}
+
+static inline int message_codec_skip_batch(reader_t *reader)
+{
+	int32_t count;
+
+	if (reader_read_int32(reader, &count))
+		return -1;
+	return message_codec_skip_batch_entries(reader, count);
+}
+
+static inline int message_codec_write_v2_batch(writer_t *writer, const message_field_batch_t *value)
+{
+	int err = message_codec_write_v2_int32(writer, &value->count);
+	err |= writer_write_bytes(writer, value->data, value->size);
+	return err;
+}
+
+static inline int message_codec_read_v2_batch(reader_t *reader, message_field_batch_t *value)
+{
+	int32_t count;
+
+	if (message_codec_read_v2_int32(reader, &count))
+		return -1;
+	return message_codec_read_batch_entries(reader, count, value);
+}
+
+static inline int message_codec_skip_v2_batch(reader_t *reader)
+{
+	int32_t count;
+
+	if (message_codec_read_v2_int32(reader, &count))
+		return -1;
+	return message_codec_skip_batch_entries(reader, count);
+}
+
+/*
+ * Base message header.
+ * v1: int64 serial, int32 type, int64 timestamp, preceded by int32 type
+ * written separately. Header has fixed size, so it is read with one
+ * bounds check.
+ * v2: 1-byte MESSAGE_WIRE_V2_MARK | type, varint serial, varint timestamp.
+ */
+
+static inline int message_codec_write_header(writer_t *writer, const message_t *message)
+{
+	int err = 0;
+
+	err |= writer_write_int64(writer, message->serial);
+	err |= writer_write_int32(writer, message->type);
+	err |= writer_write_int64(writer, message->timestamp);
+
+	return err;
+}
+
+#define MESSAGE_CODEC_HEADER_SIZE (sizeof(int64_t) + sizeof(int32_t) + sizeof(int64_t))
+
+static inline int message_codec_read_header(reader_t *reader, message_t *message)
+{
+	const char *data = reader_take(reader, MESSAGE_CODEC_HEADER_SIZE);
+
+	if (!data)
+		return -1;
+
+	message->serial = reader_load_be64(data);
+	message->type = reader_load_be32(data + sizeof(int64_t));
+	message->timestamp = reader_load_be64(data + sizeof(int64_t) + sizeof(int32_t));
+
+	return 0;
+}
+
+/* v1 header fields have fixed offsets in the datagram, so they can be patched in place */
+#define MESSAGE_CODEC_SERIAL_OFFSET sizeof(int32_t)
+#define MESSAGE_CODEC_TIMESTAMP_OFFSET (sizeof(int32_t) + sizeof(int64_t) + sizeof(int32_t))
+#define MESSAGE_CODEC_DATAGRAM_HEADER_SIZE (sizeof(int32_t) + MESSAGE_CODEC_HEADER_SIZE)
+
+static inline void message_codec_patch_header(char *datagram, int64_t serial, int64_t timestamp)
+{
+	uint64_t value;
+
+	value = htobe64(serial);
+	memcpy(datagram + MESSAGE_CODEC_SERIAL_OFFSET, &value, sizeof(value));
+	value = htobe64(timestamp);
+	memcpy(datagram + MESSAGE_CODEC_TIMESTAMP_OFFSET, &value, sizeof(value));
+}
+
+static inline int message_codec_write_header_v2(writer_t *writer, const message_t *message)
+{
+	int err = 0;
+
+	err |= writer_write_char(writer, MESSAGE_WIRE_V2_MARK | message->type);
+	err |= writer_write_varint(writer, message_codec_zigzag(message->serial));
+	err |= writer_write_varint(writer, message_codec_zigzag(message->timestamp));
+
+	return err;
+}
+
+static inline int message_codec_read_header_v2(reader_t *reader, message_t *message)
+{
+	char type;
+
+	if (reader_read_char(reader, &type) || !(type & MESSAGE_WIRE_V2_MARK))
+		return -1;
+
+	message->type = (unsigned char)type & ~MESSAGE_WIRE_V2_MARK;
+	if (message_codec_read_v2_int64(reader, &message->serial) ||
+			message_codec_read_v2_int64(reader, &message->timestamp))
+		return -1;
+
+	return 0;
+}
+
+#define MESSAGE_CODEC_WRITE_FIELD(kind, member, default) \
+	err |= message_codec_write_##kind(writer, &message->member);
+#define MESSAGE_CODEC_READ_FIELD(kind, member, default) \
+	err |= message_codec_read_##kind(reader, &message->member);
+#define MESSAGE_CODEC_SKIP_FIELD(kind, member, default) \
+	err |= message_codec_skip_##kind(reader);
+#define MESSAGE_CODEC_WRITE_FIELD_V2(kind, member, default) \
+	err |= message_codec_write_v2_##kind(writer, &message->member);
+#define MESSAGE_CODEC_READ_FIELD_V2(kind, member, default) \
+	err |= message_codec_read_v2_##kind(reader, &message->member);
+#define MESSAGE_CODEC_SKIP_FIELD_V2(kind, member, default) \
+	err |= message_codec_skip_v2_##kind(reader);
+
+/*
+ * For every MESSAGE_SCHEMA entry defines:
+ * - message_<name>_encode[_v2](writer, message) writing header and payload,
+ * - message_<name>_decode[_v2](reader, message) reading header and payload,
+ * - message_<name>_validate[_v2](reader) checking payload that follows header.
+ */
+#define MESSAGE_CODEC_DEFINE(TYPE, name, FIELDS) \
+	static inline int message_##name##_encode(writer_t *writer, const message_##name##_t *message) \
+	{ \
+		int err = message_codec_write_header(writer, &message->base); \
+		FIELDS(MESSAGE_CODEC_WRITE_FIELD) \
+		return err; \
+	} \
+	static inline int message_##name##_decode(reader_t *reader, message_##name##_t *message) \
+	{ \
+		int err = message_codec_read_header(reader, &message->base); \
+		FIELDS(MESSAGE_CODEC_READ_FIELD) \
+		return err; \
+	} \
+	static inline int message_##name##_validate(reader_t *reader) \
+	{ \
+		int err = 0; \
+		(void)reader; \
+		FIELDS(MESSAGE_CODEC_SKIP_FIELD) \
+		return err; \
+	} \
+	static inline int message_##name##_encode_v2(writer_t *writer, const message_##name##_t *message) \
+	{ \
+		int err = message_codec_write_header_v2(writer, &message->base); \
+		FIELDS(MESSAGE_CODEC_WRITE_FIELD_V2) \
+		return err; \
+	} \
+	static inline int message_##name##_decode_v2(reader_t *reader, message_##name##_t *message) \
+	{ \
+		int err = message_codec_read_header_v2(reader, &message->base); \
+		FIELDS(MESSAGE_CODEC_READ_FIELD_V2) \
+		return err; \
+	} \
+	static inline int message_##name##_validate_v2(reader_t *reader) \
+	{ \
+		int err = 0; \
+		(void)reader; \
+		FIELDS(MESSAGE_CODEC_SKIP_FIELD_V2) \
+		return err; \
+	}
+
+MESSAGE_SCHEMA(MESSAGE_CODEC_DEFINE)
+
+#define MESSAGE_CODEC_VALIDATE_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		return version == MESSAGE_WIRE_V2 ? \
+			message_##name##_validate_v2(reader) : message_##name##_validate(reader);
+
+/**
+ * @brief Validates payload of the message of given type.
+ *
+ * @param[in] reader reader positioned after message header.
+ * @param[in] type message type.
+ * @param[in] version wire format version of the datagram.
+ *
+ * @return 0 if reader holds valid payload, other value otherwise.
+ */
+static inline int message_codec_validate(reader_t *reader, message_type_e type, message_wire_version_e version)
+{
+	switch (type) {
+	MESSAGE_SCHEMA(MESSAGE_CODEC_VALIDATE_CASE)
+	default:
+		return -1;
+	}
+}
+
+#undef MESSAGE_CODEC_VALIDATE_CASE
+#undef MESSAGE_CODEC_DEFINE
+#undef MESSAGE_CODEC_SKIP_FIELD_V2
+#undef MESSAGE_CODEC_READ_FIELD_V2
+#undef MESSAGE_CODEC_WRITE_FIELD_V2
+#undef MESSAGE_CODEC_SKIP_FIELD
+#undef MESSAGE_CODEC_READ_FIELD
+#undef MESSAGE_CODEC_WRITE_FIELD
+
+#endif /* end of include guard: MESSAGE_CODEC_H */
@@ -17,28 +17,17 @@
 #ifndef MESSAGE_COMMAND_H
 #define MESSAGE_COMMAND_H
 
-#include "command.h"
-#include "messages/message.h"
+#include "messages/message_types.h"
 
-/**
- * @brief Command message data
- */
-typedef struct message_command {
-	message_t base;    /** Base class */
-	command_s command; /** Command carried by message */
-} message_command_t;
-
-/**
- * @brief Initializes message_command_t object.
- *
- * @param[in] message ack message.
+/*
+ * message_command_t with its init, destroy, serialize and deserialize
+ * functions is generated from MESSAGE_SCHEMA, see message_types.h.
  */
-void message_command_init(message_command_t *message);
 
 /**
  * @brief Get command for mesage.
  *
- * @param[in] message ack message.
+ * @param[in] message command message.
  *
  * @return command const pointer.
  */
@@ -47,36 +36,9 @@ const command_s *message_command_get_command(message_command_t *message);
 /**
  * @brief Set command for mesage.
  *
- * @param[in] message ack message.
+ * @param[in] message command message.
  * @param[in] command command to be set.
  */
 void message_command_set_command(message_command_t *message, const command_s *cmd);
 
-/**
- * @brief Destroys message_command_t object.
- *
- * @param[in] message ack message.
- */
-void message_command_destroy(message_command_t *message);
-
-/**
- * @brief Deserializes message_command_t from reader's buffer.
- *
- * @param[in] message ack message.
- * @param[in] reader reader object.
- *
- * @return 0 on success, other value on failure.
- */
-int message_command_deserialize(message_command_t *message, reader_t *reader);
-
-/**
- * @brief Serializes message_command_t into writer's buffer.
- *
- * @param[in] message message object.
- * @param[in] writer writer object.
- *
- * @return 0 on success, other value on failure.
- */
-int message_command_serialize(message_command_t *message, writer_t *writer);
-
 #endif /* end of include guard: MESSAGE_COMMAND_H */
@@ -18,8 +18,44 @@
 #define MESSAGE_MANAGER_H_
 
 #include "messages/message.h"
+#include "messages/message_view.h"
+#include "messages/message_pool.h"
 
-typedef void (*receive_message_cb)(message_t *message, void *user_data);
+/**
+ * @brief Called for every valid message received.
+ *
+ * @param[in] message view over the receive buffer, valid only during the call.
+ * @param[in] user_data user data.
+ *
+ * @note sub-messages of BATCH are passed one by one, in order, followed
+ * by the BATCH message itself.
+ */
+typedef void (*receive_message_cb)(const message_view_t *message, void *user_data);
+
+/**
+ * @brief Called for every valid message as soon as it is received.
+ *
+ * @param[in] message view over the receive buffer, valid only during the call.
+ * @param[in] user_data user data.
+ *
+ * @return true if message should be passed to receive_message_cb, false to drop it.
+ *
+ * @note unlike receive_message_cb, it sees every COMMAND before coalescing,
+ * in arrival order. BATCH message is passed before its sub-messages, which
+ * are dropped together with it.
+ */
+typedef bool (*receive_filter_cb)(const message_view_t *message, void *user_data);
+
+/**
+ * @brief Counters of the COMMAND coalescing stage.
+ */
+typedef struct message_manager_stats {
+	unsigned long long commands_received;  /** COMMAND messages successfully decoded */
+	unsigned long long commands_coalesced; /** COMMAND messages superseded by newer one from the same batch */
+	unsigned long long commands_dropped;   /** COMMAND messages older than already pending one */
+	unsigned long long batches_received;   /** BATCH messages successfully decoded */
+	unsigned long long batched_messages;   /** Valid sub-messages carried by BATCH messages */
+} message_manager_stats_s;
 
 /**
  * @brief Initializes message manager module.
@@ -34,9 +70,40 @@ int message_manager_init();
  * @return 0 on success, other value on error.
  *
  * @note the @message_manager_init should be called beforehead.
+ * Messages sent from receive callback are queued and sent together
+ * with single syscall after all messages of the receive batch were handled.
  */
 int message_manager_send_message(message_t *message);
 
+/**
+ * @brief Send the same message to several receivers.
+ *
+ * @param[in] message message to send, its receiver is not used.
+ * @param[in] receivers receiver endpoints.
+ * @param[in] count number of @receivers.
+ *
+ * @return 0 on success, other value if sending to any receiver failed.
+ *
+ * @note message is encoded once in MESSAGE_WIRE_V1 and all datagrams
+ * are sent with single syscall, when the receive batch ends or at once
+ * outside of receive callback.
+ */
+int message_manager_send_message_to_all(message_t *message, const endpoint_t *receivers, unsigned int count);
+
+/**
+ * @brief Send prebuilt datagram using message manager connection.
+ *
+ * @param[in] prebuilt prebuilt datagram, its serial and timestamp
+ * are patched before sending.
+ * @param[in] receiver receiver endpoint.
+ *
+ * @return 0 on success, other value on error.
+ *
+ * @note prebuilt datagrams are MESSAGE_WIRE_V1 regardless of the version
+ * negotiated with @receiver, so they should be used for handshake messages.
+ */
+int message_manager_send_prebuilt(message_prebuilt_t *prebuilt, const endpoint_t *receiver);
+
 /**
  * @brief Set message recieved callback.
  *
@@ -45,6 +112,38 @@ int message_manager_send_message(message_t *message);
  */
 void message_manager_set_receive_message_cb(receive_message_cb callback, void *user_data);
 
+/**
+ * @brief Set filter of received messages.
+ *
+ * @param[in] callback user callback, NULL accepts all messages.
+ * @param[in] user_data user data.
+ */
+void message_manager_set_receive_filter_cb(receive_filter_cb callback, void *user_data);
+
+/**
+ * @brief Sets wire format version negotiated with the peer.
+ *
+ * @param[in] peer controller endpoint.
+ * @param[in] version version used for messages sent to @peer.
+ *
+ * @note messages to other endpoints and CONNECT* handshake messages
+ * are always sent in MESSAGE_WIRE_V1. Received messages are accepted
+ * in any version. Destination of @peer is resolved here once and reused
+ * by all sends to it.
+ */
+void message_manager_set_peer_version(const endpoint_t *peer, message_wire_version_e version);
+
+/**
+ * @brief Gets COMMAND coalescing counters.
+ *
+ * @param[out] stats counters collected since @message_manager_init.
+ *
+ * @note COMMAND messages received in one socket batch are coalesced, only
+ * the one with the highest serial is passed to receive callback after all
+ * other messages of the batch were handled in order.
+ */
+void message_manager_get_stats(message_manager_stats_s *stats);
+
 /**
  * @brief Shutdowns message manager module.
  *
@@ -0,0 +1,106 @@
+/*
+* Copyright (c) 2018 Samsung Electronics Co., Ltd.
+*
+* Licensed under the Flora License, Version 1.1 (the License);
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://floralicense.org/license/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include "messages/message_types.h"
+
+/**
+ * @brief the pool handle.
+ *
+ * Pool holds one message of every type, initialized once when the pool
+ * is created. Taking a message from the pool only assigns new serial
+ * number and resets payload fields to their schema defaults.
+ */
+typedef struct _message_pool message_pool_t;
+
+/**
+ * @brief Creates new instance of message pool.
+ *
+ * @return new pool pointer or NULL on error.
+ */
+message_pool_t *message_pool_create();
+
+/**
+ * @brief Destroys pool instance.
+ *
+ * @param[in] pool pool pointer.
+ */
+void message_pool_destroy(message_pool_t *pool);
+
+/**
+ * @brief Returns pooled message of given type.
+ *
+ * @param[in] pool pool pointer.
+ * @param[in] type type of the message.
+ *
+ * @return message pointer or NULL for unknown type.
+ *
+ * @note only ONE message of every type is valid at time, next call for
+ * the same type returns the same message renewed. Messages of the pool
+ * keep their receiver, they should not be destroyed by the user.
+ */
+message_t *message_pool_get(message_pool_t *pool, message_type_e type);
+
+/*
+ * For every MESSAGE_SCHEMA entry declares:
+ *
+ * message_<name>_t *message_pool_get_<name>(message_pool_t *pool);
+ *	Typed variant of @message_pool_get.
+ */
+#define MESSAGE_POOL_DECLARE(TYPE, name, FIELDS) \
+	message_##name##_t *message_pool_get_##name(message_pool_t *pool);
+
+MESSAGE_SCHEMA(MESSAGE_POOL_DECLARE)
+
+#undef MESSAGE_POOL_DECLARE
+
+#define MESSAGE_PREBUILT_MAX_SIZE 64
+
+/**
+ * @brief Message serialized once and sent many times.
+ *
+ * Datagram is always encoded in MESSAGE_WIRE_V1, where header fields
+ * have fixed offsets, so serial and timestamp are patched in place
+ * before every send.
+ */
+typedef struct message_prebuilt {
+	char data[MESSAGE_PREBUILT_MAX_SIZE]; /** Encoded datagram */
+	size_t size;                          /** Length of the datagram, 0 if not built */
+} message_prebuilt_t;
+
+/**
+ * @brief Serializes message into prebuilt datagram.
+ *
+ * @param[out] prebuilt prebuilt datagram.
+ * @param[in] message message object, its serial and timestamp are
+ * replaced on send.
+ *
+ * @return 0 on success, other value if message does not fit.
+ */
+int message_prebuilt_init(message_prebuilt_t *prebuilt, message_t *message);
+
+/**
+ * @brief Patches header of the prebuilt datagram.
+ *
+ * @param[in] prebuilt prebuilt datagram.
+ * @param[in] serial serial number of the message.
+ * @param[in] timestamp Milliseconds since Epoch.
+ */
+void message_prebuilt_patch(message_prebuilt_t *prebuilt, int64_t serial, int64_t timestamp);
+
+#endif /* end of include guard: MESSAGE_POOL_H */
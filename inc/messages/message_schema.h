@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2018 Samsung Electronics Co., Ltd.
+*
+* Licensed under the Flora License, Version 1.1 (the License);
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://floralicense.org/license/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef MESSAGE_SCHEMA_H
+#define MESSAGE_SCHEMA_H
+
+/**
+ * @brief Wire schema of all messages.
+ *
+ * Every entry is X(TYPE, name, FIELDS), where:
+ * - TYPE is the suffix of message_type_e value (MESSAGE_<TYPE>),
+ * - name is used for message_<name>_t type and its functions,
+ * - FIELDS(F) lists payload fields as F(kind, member, default), serialized
+ *   in order after the base message header.
+ *
+ * Supported field kinds are int32, int64, bool, command, version, role and batch,
+ * see message_codec.h. Order of entries defines message_type_e values
+ * sent on the wire, so new messages have to be appended.
+ *
+ * @note adding a message only requires an entry here, types, codecs,
+ * factory and view validation are generated from it.
+ */
+#define MESSAGE_SCHEMA(X) \
+	X(CONNECT,          connect,          MESSAGE_CONNECT_FIELDS)          /** Connection request */ \
+	X(CONNECT_ACCEPTED, connect_accepted, MESSAGE_CONNECT_FIELDS)          /** Connection accepted reply */ \
+	X(CONNECT_REFUSED,  connect_refused,  MESSAGE_FIELDS_NONE)             /** Connection refused reply */ \
+	X(KEEP_ALIVE,       keep_alive,       MESSAGE_FIELDS_NONE)             /** Keep alive request */ \
+	X(ACK,              ack,              MESSAGE_ACK_FIELDS)              /** Message delivery confirmation */ \
+	X(COMMAND,          command,          MESSAGE_COMMAND_FIELDS)          /** Message with command data */ \
+	X(BYE,              bye,              MESSAGE_FIELDS_NONE)             /** Connection end request */ \
+	X(BATCH,            batch,            MESSAGE_BATCH_FIELDS)            /** Several messages in one datagram */ \
+	X(LINK_STATS,       link_stats,       MESSAGE_LINK_STATS_FIELDS)       /** Link quality seen by the car */
+
+#define MESSAGE_FIELDS_NONE(F)
+
+/**
+ * Highest wire version supported by the sender of CONNECT, version
+ * chosen by the car in CONNECT_ACCEPTED. Missing in messages of
+ * controllers that predate v2, which are read as MESSAGE_WIRE_V1.
+ * Role requested by the sender of CONNECT, role granted by the car in
+ * CONNECT_ACCEPTED. Missing in messages of controllers that predate
+ * observers, which are read as MESSAGE_ROLE_DRIVER.
+ */
+#define MESSAGE_CONNECT_FIELDS(F) \
+	F(version, version, MESSAGE_WIRE_V1) \
+	F(role, role, MESSAGE_ROLE_DRIVER)
+
+/** The serial of message which reception is confirmed, -1 if not set */
+#define MESSAGE_ACK_FIELDS(F) \
+	F(int64, ack_serial, -1)
+
+/** Command carried by message */
+#define MESSAGE_COMMAND_FIELDS(F) \
+	F(command, command, { .type = COMMAND_TYPE_NONE })
+
+/** Encoded sub-messages, see message_batch.h */
+#define MESSAGE_BATCH_FIELDS(F) \
+	F(batch, entries, { .data = NULL })
+
+/**
+ * Link statistics of the session, see link_stats.h. Round trip times are
+ * -1 until the controller acknowledges the first LINK_STATS message.
+ * Times are in microseconds, counters are totals since CONNECT.
+ */
+#define MESSAGE_LINK_STATS_FIELDS(F) \
+	F(int32, rtt, -1) \
+	F(int32, rtt_var, -1) \
+	F(int32, jitter, 0) \
+	F(int64, received, 0) \
+	F(int64, lost, 0) \
+	F(int64, reordered, 0)
+
+#endif /* end of include guard: MESSAGE_SCHEMA_H */
@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2018 Samsung Electronics Co., Ltd.
+*
+* Licensed under the Flora License, Version 1.1 (the License);
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://floralicense.org/license/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef MESSAGE_TYPES_H
+#define MESSAGE_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "command.h"
+#include "messages/message.h"
+
+/**
+ * @brief Sub-messages of a BATCH message.
+ *
+ * Every entry is a complete datagram of any wire version, preceded by
+ * its length as big endian uint16.
+ */
+typedef struct message_batch_entries {
+	const char *data; /** Entries, not owned */
+	size_t size;      /** Length of @data in bytes */
+	int32_t count;    /** Number of entries */
+} message_batch_entries_s;
+
+/**
+ * @brief C types of schema field kinds.
+ */
+typedef int32_t message_field_int32_t;
+typedef int64_t message_field_int64_t;
+typedef bool message_field_bool_t;
+typedef command_s message_field_command_t;
+typedef message_wire_version_e message_field_version_t;
+typedef message_role_e message_field_role_t;
+typedef message_batch_entries_s message_field_batch_t;
+
+#define MESSAGE_TYPES_MEMBER(kind, member, default) message_field_##kind##_t member;
+
+/*
+ * For every MESSAGE_SCHEMA entry declares:
+ *
+ * typedef struct message_<name> {
+ *	message_t base;  // Base class
+ *	...              // payload fields
+ * } message_<name>_t;
+ *
+ * void message_<name>_init(message_<name>_t *message);
+ *	Initializes message, assigns new serial and fields defaults.
+ *
+ * void message_<name>_destroy(message_<name>_t *message);
+ *	Destroys message.
+ *
+ * int message_<name>_deserialize(message_<name>_t *message, reader_t *reader);
+ *	Deserializes message from reader's buffer, 0 on success.
+ *
+ * int message_<name>_serialize(message_<name>_t *message, writer_t *writer);
+ *	Serializes message into writer's buffer, 0 on success.
+ */
+#define MESSAGE_TYPES_DECLARE(TYPE, name, FIELDS) \
+	typedef struct message_##name { \
+		message_t base; \
+		FIELDS(MESSAGE_TYPES_MEMBER) \
+	} message_##name##_t; \
+	void message_##name##_init(message_##name##_t *message); \
+	void message_##name##_destroy(message_##name##_t *message); \
+	int message_##name##_deserialize(message_##name##_t *message, reader_t *reader); \
+	int message_##name##_serialize(message_##name##_t *message, writer_t *writer);
+
+MESSAGE_SCHEMA(MESSAGE_TYPES_DECLARE)
+
+#undef MESSAGE_TYPES_DECLARE
+#undef MESSAGE_TYPES_MEMBER
+
+#endif /* end of include guard: MESSAGE_TYPES_H */
@@ -0,0 +1,194 @@
+/*
+* Copyright (c) 2018 Samsung Electronics Co., Ltd.
+*
+* Licensed under the Flora License, Version 1.1 (the License);
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://floralicense.org/license/
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef MESSAGE_VIEW_H
+#define MESSAGE_VIEW_H
+
+#include "command.h"
+#include "messages/message.h"
+
+/**
+ * @brief Read-only view over a received datagram.
+ *
+ * Header fields are decoded once by @message_view_init, payload stays
+ * in the receive buffer and is decoded on access by the typed getters.
+ */
+typedef struct message_view {
+	int64_t serial;                 /** Serial number of the message */
+	int64_t timestamp;              /** Milliseconds since Epoch */
+	message_type_e type;            /** Message type */
+	message_wire_version_e version; /** Wire format the datagram was encoded with */
+	endpoint_t sender;              /** Source of the datagram */
+	const char *payload;            /** Type specific part of the datagram, not owned */
+	size_t payload_size;            /** Length of the @payload */
+	bool in_batch;                  /** Message was carried by BATCH message */
+} message_view_t;
+
+/**
+ * @brief Iterator over sub-messages of BATCH view.
+ */
+typedef struct message_view_batch_iter {
+	reader_t reader;       /** Reader over batch entries */
+	int32_t left;          /** Number of entries not visited yet */
+	endpoint_t sender;     /** Source of the batch */
+} message_view_batch_iter_t;
+
+/**
+ * @brief Validates datagram in place and initializes view over it.
+ *
+ * @param[out] view view object.
+ * @param[in] data datagram, including leading message type.
+ * @param[in] size length of the @data.
+ * @param[in] sender source of the datagram.
+ *
+ * @return 0 on success, other value if datagram is malformed.
+ *
+ * @note view points into @data, so the buffer has to outlive the view.
+ * Once initialized, payload getters of the view's type cannot fail.
+ */
+int message_view_init(message_view_t *view, const char *data, size_t size, const endpoint_t *sender);
+
+/**
+ * @brief Get type of the viewed message.
+ *
+ * @param[in] view view object.
+ *
+ * @return message type.
+ */
+static inline message_type_e message_view_get_type(const message_view_t *view)
+{
+	return view->type;
+}
+
+/**
+ * @brief Get serial number of the viewed message.
+ *
+ * @param[in] view view object.
+ *
+ * @return message serial number.
+ */
+static inline int64_t message_view_get_serial(const message_view_t *view)
+{
+	return view->serial;
+}
+
+/**
+ * @brief Get timestamp of the viewed message.
+ *
+ * @param[in] view view object.
+ *
+ * @return Milliseconds since Epoch.
+ */
+static inline int64_t message_view_get_timestamp(const message_view_t *view)
+{
+	return view->timestamp;
+}
+
+/**
+ * @brief Get sender of the viewed message.
+ *
+ * @param[in] view view object.
+ *
+ * @return sender endpoint.
+ */
+static inline const endpoint_t *message_view_get_sender(const message_view_t *view)
+{
+	return &view->sender;
+}
+
+/**
+ * @brief Get wire format version of the viewed datagram.
+ *
+ * @param[in] view view object.
+ *
+ * @return wire format version.
+ */
+static inline message_wire_version_e message_view_get_version(const message_view_t *view)
+{
+	return view->version;
+}
+
+/**
+ * @brief Decodes command carried by MESSAGE_COMMAND view.
+ *
+ * @param[in] view view object.
+ * @param[out] command decoded command.
+ *
+ * @return 0 on success, other value if view is not MESSAGE_COMMAND.
+ */
+int message_view_get_command(const message_view_t *view, command_s *command);
+
+/**
+ * @brief Decodes confirmed serial carried by MESSAGE_ACK view.
+ *
+ * @param[in] view view object.
+ * @param[out] ack_serial serial number of confirmed message.
+ *
+ * @return 0 on success, other value if view is not MESSAGE_ACK.
+ */
+int message_view_get_ack_serial(const message_view_t *view, int64_t *ack_serial);
+
+/**
+ * @brief Decodes wire version carried by MESSAGE_CONNECT or
+ * MESSAGE_CONNECT_ACCEPTED view.
+ *
+ * @param[in] view view object.
+ * @param[out] version highest version supported by CONNECT sender,
+ * or version chosen by CONNECT_ACCEPTED sender.
+ *
+ * @return 0 on success, other value if view is not one of above types.
+ *
+ * @note MESSAGE_WIRE_V1 is returned for controllers which do not send it.
+ */
+int message_view_get_peer_version(const message_view_t *view, message_wire_version_e *version);
+
+/**
+ * @brief Decodes role carried by MESSAGE_CONNECT or MESSAGE_CONNECT_ACCEPTED view.
+ *
+ * @param[in] view view object.
+ * @param[out] role role requested by CONNECT sender, or role granted
+ * by CONNECT_ACCEPTED sender.
+ *
+ * @return 0 on success, other value if view is not one of above types.
+ *
+ * @note MESSAGE_ROLE_DRIVER is returned for controllers which do not send it.
+ */
+int message_view_get_peer_role(const message_view_t *view, message_role_e *role);
+
+/**
+ * @brief Starts iteration over sub-messages of MESSAGE_BATCH view.
+ *
+ * @param[in] view view object.
+ * @param[out] iter iterator object.
+ *
+ * @return 0 on success, other value if view is not MESSAGE_BATCH.
+ */
+int message_view_batch_begin(const message_view_t *view, message_view_batch_iter_t *iter);
+
+/**
+ * @brief Gets next sub-message of the batch.
+ *
+ * @param[in] iter iterator object.
+ * @param[out] sub view over the sub-message.
+ *
+ * @return true if @sub was initialized, false when all entries were visited.
+ *
+ * @note malformed sub-messages and nested batches are skipped, so
+ * every entry is validated exactly once, while iterating.
+ */
+bool message_view_batch_next(message_view_batch_iter_t *iter, message_view_t *sub);
+
+#endif /* end of include guard: MESSAGE_VIEW_H */
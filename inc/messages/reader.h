@@ -19,6 +19,9 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
 
 typedef struct _reader reader_t;
 
@@ -48,7 +51,86 @@ void reader_init_static(reader_t *reader, const char *data, size_t length);
  */
 void reader_reset(reader_t *reader);
 
-/** * @brief Reads 32-bit integer value from buffer
+/**
+ * @brief Takes fixed size span of the buffer with single bounds check
+ *
+ * @param[in] reader reader object
+ * @param[in] length length of the span
+ *
+ * @return pointer to the span, NULL if buffer holds less than @length
+ * bytes. On failure reader is not advanced.
+ * @note span is not aligned, its fields should be loaded with
+ * @reader_load_be16, @reader_load_be32 and @reader_load_be64.
+ */
+static inline const char *reader_take(reader_t *reader, size_t length)
+{
+	const char *span;
+
+	if (length > reader->len - reader->offset)
+		return NULL;
+
+	span = reader->data + reader->offset;
+	reader->offset += length;
+	return span;
+}
+
+/**
+ * @brief Loads big endian 16-bit integer from possibly unaligned address
+ *
+ * @param[in] data address of the value
+ *
+ * @return loaded value
+ */
+static inline int16_t reader_load_be16(const char *data)
+{
+	uint16_t value;
+
+	memcpy(&value, data, sizeof(value));
+	return be16toh(value);
+}
+
+/**
+ * @brief Loads big endian 32-bit integer from possibly unaligned address
+ *
+ * @param[in] data address of the value
+ *
+ * @return loaded value
+ */
+static inline int32_t reader_load_be32(const char *data)
+{
+	uint32_t value;
+
+	memcpy(&value, data, sizeof(value));
+	return be32toh(value);
+}
+
+/**
+ * @brief Loads big endian 64-bit integer from possibly unaligned address
+ *
+ * @param[in] data address of the value
+ *
+ * @return loaded value
+ */
+static inline int64_t reader_load_be64(const char *data)
+{
+	uint64_t value;
+
+	memcpy(&value, data, sizeof(value));
+	return be64toh(value);
+}
+
+/**
+ * @brief Reads 16-bit integer value from buffer
+ *
+ * @param[in] reader reader object
+ * @param[out] value output value
+ *
+ * @return 0 on success, other value on failure.
+ */
+int reader_read_int16(reader_t *reader, int16_t *value);
+
+/**
+ * @brief Reads 32-bit integer value from buffer
  *
  * @param[in] reader reader object
  * @param[out] value output value
@@ -67,6 +149,18 @@ int reader_read_int32(reader_t *reader, int32_t *value);
  */
 int reader_read_int64(reader_t *reader, int64_t *value);
 
+/**
+ * @brief Reads variable length integer value from buffer
+ *
+ * @param[in] reader reader object
+ * @param[out] value output value
+ *
+ * @return 0 on success, other value on failure.
+ * @note see @writer_write_varint for the encoding, values longer
+ * than 10 bytes are rejected.
+ */
+int reader_read_varint(reader_t *reader, uint64_t *value);
+
 /**
  * @brief Reads character value from buffer
  *
@@ -98,4 +192,17 @@ int reader_read_bool(reader_t *reader, bool *value);
  */
 int reader_read_string(reader_t *reader, char **value);
 
+/**
+ * @brief Reads string value from buffer without copying it
+ *
+ * @param[in] reader reader object
+ * @param[out] value start of the string inside reader's buffer
+ * @param[out] length length of the string
+ *
+ * @return 0 on success, other value on failure.
+ * @note value is not null terminated and is valid as long as
+ * the reader's buffer.
+ */
+int reader_read_string_view(reader_t *reader, const char **value, size_t *length);
+
 #endif /* end of include guard: READER_H */
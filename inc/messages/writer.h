@@ -19,6 +19,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct _writer writer_t;
 
@@ -30,6 +31,7 @@ struct _writer
 	char *data;
 	size_t length;
 	size_t cap;
+	bool fixed; /** data is caller's storage, it is never reallocated nor freed */
 };
 
 /**
@@ -42,10 +44,38 @@ struct _writer
  */
 int writer_init_sized(writer_t *writer, size_t length);
 
+/**
+ * @brief Initializes writer object over caller provided storage
+ *
+ * Writer never allocates, writes which do not fit into @storage fail.
+ *
+ * @param[in] writer writer object.
+ * @param[in] storage buffer for written data, e.g. on stack.
+ * @param[in] size size of the @storage.
+ */
+void writer_init_static(writer_t *writer, char *storage, size_t size);
+
+/**
+ * @brief Makes sure that next @length bytes can be written without
+ * reallocation.
+ *
+ * Buffer of heap backed writer grows geometrically, so repeated
+ * small writes cost amortized constant time.
+ *
+ * @param[in] writer writer object.
+ * @param[in] length number of bytes to be written.
+ *
+ * @return 0 on success, other value on error. On error previously
+ * written data is left intact.
+ */
+int writer_reserve(writer_t *writer, size_t length);
+
 /**
  * @brief Shutdowns writer object
  *
  * @param[in] writer writer object.
+ *
+ * @note storage passed to @writer_init_static is not freed.
  */
 void writer_shutdown(writer_t *writer);
 
@@ -62,6 +92,16 @@ void writer_shutdown(writer_t *writer);
  */
 void writer_reset(writer_t *buf, size_t position);
 
+/**
+ * @brief Writes value into writer's buffer
+ *
+ * @param[in] writer writer object
+ * @param[in] value value to write into the writer's buffer
+ *
+ * @return 0 on success, other value on error.
+ */
+int writer_write_int16(writer_t *writer, int16_t value);
+
 /**
  * @brief Writes value into writer's buffer
  *
@@ -82,6 +122,19 @@ int writer_write_int32(writer_t *writer, int32_t value);
  */
 int writer_write_int64(writer_t *writer, int64_t value);
 
+/**
+ * @brief Writes value as variable length integer into writer's buffer
+ *
+ * Value is stored in 7-bit groups, least significant first, with
+ * the highest bit of every byte but the last one set (LEB128).
+ *
+ * @param[in] writer writer object
+ * @param[in] value value to write into the writer's buffer
+ *
+ * @return 0 on success, other value on error.
+ */
+int writer_write_varint(writer_t *writer, uint64_t value);
+
 /**
  * @brief Writes value into writer's buffer
  *
@@ -112,4 +165,15 @@ int writer_write_char(writer_t *writer, char value);
  */
 int writer_write_string(writer_t *writer, const char *value);
 
+/**
+ * @brief Writes raw bytes into writer's buffer
+ *
+ * @param[in] writer writer object
+ * @param[in] data bytes to write into the writer's buffer
+ * @param[in] length number of bytes
+ *
+ * @return 0 on success, other value on error.
+ */
+int writer_write_bytes(writer_t *writer, const void *data, size_t length);
+
 #endif /* end of include guard: WRITER_H */
@@ -26,6 +26,14 @@
 #include "resource/resource_motor_driver_L298N.h"
 #include "resource/resource_servo_motor.h"
 
+/*
+ * Motors are configured and driven only when non-zero, shared by the app
+ * and car control. Build with -DENABLE_MOTOR=0 to run without motors.
+ */
+#ifndef ENABLE_MOTOR
+#define ENABLE_MOTOR 1
+#endif
+
 void resource_close_all(void);
 
 #endif /* __POSITION_FINDER_RESOURCE_H__ */
@@ -19,11 +19,64 @@
 #ifndef __RESOURCE_PCA9685_H__
 #define __RESOURCE_PCA9685_H__
 
+#include <stdbool.h>
+
 #define PCA9685_CH_MAX 15
 
+/**
+ * @brief PWM values of single PCA9685 channel.
+ */
+typedef struct pca9685_channel_value {
+	unsigned int channel;
+	int on;
+	int off;
+} pca9685_channel_value_s;
+
+/**
+ * @brief I2C traffic counters of PCA9685 driver.
+ */
+typedef struct pca9685_stats {
+	unsigned long long transactions; /* number of I2C transactions issued */
+	unsigned long long bytes;        /* number of bytes written, register addresses included */
+	unsigned long long time_ns;      /* time spent in I2C calls in nanoseconds */
+	unsigned long long cache_hits;   /* channel updates skipped because shadow registers matched */
+	unsigned long long cache_misses; /* channel updates written to the chip */
+} pca9685_stats_s;
+
 int resource_pca9685_init(unsigned int ch);
 int resource_pca9685_fini(unsigned int ch);
 int resource_pca9685_set_frequency(unsigned int freq_hz);
 int resource_pca9685_set_value_to_channel(unsigned int channel, int on, int off);
 
+/**
+ * @param[in] values The channels with values to be set
+ * @param[in] count The number of elements in values
+ *
+ * @return 0 on success, otherwise a negative error value
+ * @remarks Runs of consecutive channels are written in one I2C transaction.
+ */
+int resource_pca9685_set_values_to_channels(const pca9685_channel_value_s *values, unsigned int count);
+
+/**
+ * @param[in] enable true to write channel registers in one auto-increment
+ * transaction (default), false to write every register separately
+ */
+void resource_pca9685_set_burst_write(bool enable);
+
+/**
+ * @brief Forgets shadow copy of channel registers, so next update of
+ * every channel is written to the chip.
+ * @remarks Called internally whenever I2C write fails.
+ */
+void resource_pca9685_invalidate_cache(void);
+
+/**
+ * @brief Reloads shadow copy of channel registers from the chip.
+ * @return 0 on success, otherwise a negative error value
+ */
+int resource_pca9685_resync_cache(void);
+
+void resource_pca9685_get_stats(pca9685_stats_s *stats);
+void resource_pca9685_reset_stats(void);
+
 #endif /* __RESOURCE_PCA9685_H__ */
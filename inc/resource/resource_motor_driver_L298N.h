@@ -46,6 +46,14 @@
 #define DEFAULT_MOTOR4_EN_CH 4
 
 
+/**
+ * @brief GPIO pin-state cache counters.
+ */
+typedef struct {
+	unsigned long long hits;   /* pin writes skipped because pin already had the value */
+	unsigned long long misses; /* pin writes issued to GPIO */
+} motor_driver_L298N_stats_s;
+
 /**
  * @brief Enumeration for motor id.
  */
@@ -79,4 +87,18 @@ int resource_set_motor_driver_L298N_configuration(motor_id_e id,
  */
 int resource_set_motor_driver_L298N_speed(motor_id_e id, int speed);
 
+/**
+ * @brief Forgets cached state of all motor GPIO pins, so next write
+ * of every pin reaches the hardware.
+ * @remarks Failed GPIO write only forgets the state of the pin it failed on,
+ * this function is meant for callers which know pins were changed outside of
+ * the driver, e.g. after the GPIO controller was reset.
+ */
+void resource_motor_driver_L298N_invalidate_cache(void);
+
+/**
+ * @param[out] stats The pin-state cache counters
+ */
+void resource_motor_driver_L298N_get_stats(motor_driver_L298N_stats_s *stats);
+
 #endif /* __RESOURCE_MOTOR_DRIVER_L298N_H__ */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_SERIAL_WINDOW_H_
+#define INC_SERIAL_WINDOW_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SERIAL_WINDOW_SIZE 64
+
+/**
+ * @brief Order of received serial relative to already seen ones.
+ */
+typedef enum serial_window_result {
+	SERIAL_WINDOW_NEW,       /** Highest serial seen so far */
+	SERIAL_WINDOW_LATE,      /** Not seen yet, but older than the highest one */
+	SERIAL_WINDOW_DUPLICATE, /** Already seen */
+	SERIAL_WINDOW_STALE      /** Older than the window, cannot be told from a duplicate */
+} serial_window_result_e;
+
+/**
+ * @brief Counters of serial window results.
+ */
+typedef struct serial_window_stats {
+	unsigned long long int new;
+	unsigned long long int late;
+	unsigned long long int duplicate;
+	unsigned long long int stale;
+} serial_window_stats_s;
+
+/**
+ * @brief Sliding window over the last SERIAL_WINDOW_SIZE serials.
+ *
+ * Bit n of the bitmap tells serial @max - n was seen, so every check
+ * is a shift and a mask, like replay protection of IPsec does.
+ */
+typedef struct serial_window {
+	bool synced;     /** At least one serial was seen */
+	int64_t max;     /** Highest serial seen */
+	uint64_t bitmap; /** Seen serials, bit 0 is @max */
+	serial_window_stats_s stats;
+} serial_window_t;
+
+/**
+ * @brief Resets window, e.g. when new session starts.
+ *
+ * @param[in] window window object.
+ */
+void serial_window_init(serial_window_t *window);
+
+/**
+ * @brief Checks order of the serial and marks it as seen.
+ *
+ * @param[in] window window object.
+ * @param[in] serial serial number of received message.
+ *
+ * @return order of the serial, see serial_window_result_e.
+ */
+serial_window_result_e serial_window_update(serial_window_t *window, int64_t serial);
+
+/**
+ * @brief Gets counters of results returned by @serial_window_update.
+ *
+ * @param[in] window window object.
+ *
+ * @return counters since last @serial_window_init.
+ */
+static inline const serial_window_stats_s *serial_window_get_stats(const serial_window_t *window)
+{
+	return &window->stats;
+}
+
+#endif /* INC_SERIAL_WINDOW_H_ */
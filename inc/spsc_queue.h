@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_SPSC_QUEUE_H_
+#define INC_SPSC_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Bounded lock-free single producer, single consumer queue.
+ *
+ * @note exactly one thread may call @spsc_queue_push and exactly one
+ * (possibly other) thread may call @spsc_queue_pop.
+ */
+typedef struct spsc_queue {
+	char *buffer;
+	size_t element_size;
+	unsigned int mask;
+	unsigned int head __attribute__((aligned(64))); /** Consumer position */
+	unsigned int tail __attribute__((aligned(64))); /** Producer position */
+} spsc_queue_t;
+
+/**
+ * @brief Initializes queue.
+ *
+ * @param[in] queue queue object.
+ * @param[in] capacity number of elements, must be power of two.
+ * @param[in] element_size size of single element in bytes.
+ *
+ * @return 0 on success, other value on error.
+ */
+int spsc_queue_init(spsc_queue_t *queue, unsigned int capacity, size_t element_size);
+
+/**
+ * @brief Releases queue buffer.
+ *
+ * @param[in] queue queue object.
+ */
+void spsc_queue_shutdown(spsc_queue_t *queue);
+
+/**
+ * @brief Copies element into queue. Called by producer only.
+ *
+ * @param[in] queue queue object.
+ * @param[in] element element to be copied.
+ *
+ * @return 0 on success, other value if queue is full.
+ */
+int spsc_queue_push(spsc_queue_t *queue, const void *element);
+
+/**
+ * @brief Copies oldest element out of queue. Called by consumer only.
+ *
+ * @param[in] queue queue object.
+ * @param[out] element output element.
+ *
+ * @return 0 on success, other value if queue is empty.
+ */
+int spsc_queue_pop(spsc_queue_t *queue, void *element);
+
+/**
+ * @brief Checks if there is nothing to pop.
+ *
+ * @param[in] queue queue object.
+ *
+ * @return true if queue is empty, false otherwise.
+ */
+bool spsc_queue_is_empty(spsc_queue_t *queue);
+
+#endif /* INC_SPSC_QUEUE_H_ */
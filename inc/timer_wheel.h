@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_TIMER_WHEEL_H_
+#define INC_TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+typedef struct timer_wheel_timer timer_wheel_timer_t;
+
+/**
+ * @brief Called when timer expires.
+ *
+ * @param[in] timer expired timer, it may be scheduled again from the callback.
+ * @param[in] user_data user data.
+ */
+typedef void (*timer_wheel_cb)(timer_wheel_timer_t *timer, void *user_data);
+
+/**
+ * @brief Timer embedded in the object it belongs to.
+ */
+struct timer_wheel_timer {
+	timer_wheel_timer_t *next;
+	timer_wheel_timer_t **pprev; /** NULL when timer is not scheduled */
+	uint64_t expires;            /** Tick of expiration */
+	timer_wheel_cb cb;
+	void *user_data;
+};
+
+/**
+ * @brief Hierarchical timer wheel.
+ *
+ * Level 0 holds timers expiring within TIMER_WHEEL_SLOTS ticks, every
+ * next level covers TIMER_WHEEL_SLOTS times longer period and is
+ * cascaded into lower levels when they wrap. Scheduling and cancelling
+ * are O(1), time is taken from the caller, so wheel can be driven by
+ * any monotonic clock.
+ */
+typedef struct timer_wheel {
+	int64_t tick_ns;   /** Resolution of the wheel */
+	int64_t origin_ns; /** Time of tick 0 */
+	uint64_t current;  /** Next tick to be processed */
+	unsigned int count; /** Number of scheduled timers */
+	timer_wheel_timer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+/**
+ * @brief Initializes wheel.
+ *
+ * @param[in] wheel wheel object.
+ * @param[in] tick_ns resolution of the wheel in nanoseconds.
+ * @param[in] now_ns current time.
+ */
+void timer_wheel_init(timer_wheel_t *wheel, int64_t tick_ns, int64_t now_ns);
+
+/**
+ * @brief Initializes timer.
+ *
+ * @param[in] timer timer object.
+ * @param[in] cb callback called on expiration.
+ * @param[in] user_data data passed to @cb.
+ */
+void timer_wheel_timer_init(timer_wheel_timer_t *timer, timer_wheel_cb cb, void *user_data);
+
+/**
+ * @brief Schedules timer, already scheduled timer is moved.
+ *
+ * @param[in] wheel wheel object.
+ * @param[in] timer timer object.
+ * @param[in] deadline_ns time of expiration, rounded up to the tick.
+ *
+ * @note timer with deadline in the past expires on next @timer_wheel_advance.
+ */
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_timer_t *timer, int64_t deadline_ns);
+
+/**
+ * @brief Cancels timer, does nothing if timer is not scheduled.
+ *
+ * @param[in] wheel wheel object.
+ * @param[in] timer timer object.
+ */
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_timer_t *timer);
+
+/**
+ * @brief Checks if timer is scheduled.
+ *
+ * @param[in] timer timer object.
+ *
+ * @return true if timer is scheduled, false otherwise.
+ */
+static inline bool timer_wheel_timer_is_scheduled(const timer_wheel_timer_t *timer)
+{
+	return timer->pprev != NULL;
+}
+
+/**
+ * @brief Calls callbacks of all timers expired until given time.
+ *
+ * @param[in] wheel wheel object.
+ * @param[in] now_ns current time.
+ *
+ * @return number of expired timers.
+ */
+unsigned int timer_wheel_advance(timer_wheel_t *wheel, int64_t now_ns);
+
+/**
+ * @brief Gets time at which @timer_wheel_advance should be called next.
+ *
+ * @param[in] wheel wheel object.
+ *
+ * @return time in nanoseconds, -1 if no timer is scheduled.
+ *
+ * @note returned time is never later than the nearest deadline, but
+ * may be earlier when timers of higher levels have to be cascaded.
+ */
+int64_t timer_wheel_next_deadline(const timer_wheel_t *wheel);
+
+#endif /* INC_TIMER_WHEEL_H_ */
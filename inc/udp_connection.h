@@ -17,25 +17,64 @@
 #ifndef INC_UDP_CONNECTION_H_
 #define INC_UDP_CONNECTION_H_
 
+#include <netinet/in.h>
+#include "endpoint.h"
+
 /**
  * @brief Called whenever new UDP data arrives.
  * @param[in] data Pointer to data that arrived.
  * @param[in] size Size of data in bytes.
- * @param[in] address Address of source of data.
- * @param[in] port Port of data source.
+ * @param[in] sender Endpoint of data source.
+ * @remarks Data stays valid until udp_batch_end_cb of the same batch returns.
+ */
+typedef void (*udp_receive_cb)(const char *data, unsigned int size, const endpoint_t *sender);
+
+/**
+ * @brief Called after all datagrams read in a single wakeup were passed to udp_receive_cb.
+ * @param[in] count Number of datagrams in the batch.
  */
-typedef void (*udp_receive_cb)(const char *data, unsigned int size, const char *address, int port);
+typedef void (*udp_batch_end_cb)(unsigned int count);
 
 /**
  * @brief Structure of data about udp_connection.
  */
 typedef struct udp_connection udp_connection_t;
 
+/**
+ * @brief Receive and send counters of udp_connection.
+ */
+typedef struct udp_connection_stats {
+	unsigned long long wakeups;       /** Number of times socket was reported readable. */
+	unsigned long long syscalls;      /** Number of receive syscalls issued. */
+	unsigned long long datagrams;     /** Number of datagrams handed to receive callback. */
+	unsigned long long dropped;       /** Number of datagrams dropped due to their size. */
+	unsigned int max_batch;           /** Largest number of datagrams received in one wakeup. */
+	unsigned long long sent;          /** Number of datagrams sent. */
+	unsigned long long send_syscalls; /** Number of send syscalls issued. */
+	unsigned long long send_dropped;  /** Number of datagrams which could not be sent. */
+} udp_connection_stats_s;
+
+/**
+ * @brief Destination resolved once to the form used by the socket.
+ */
+typedef struct udp_destination {
+	struct sockaddr_in address; /** Native socket address. */
+	endpoint_t endpoint;        /** Endpoint the destination was created for. */
+} udp_destination_t;
+
+/**
+ * @brief Resolves destination of datagrams.
+ * @param[out] destination Destination to fill.
+ * @param[in] endpoint Endpoint of receiver.
+ */
+void udp_destination_init(udp_destination_t *destination, const endpoint_t *endpoint);
+
 /**
  * @brief Creates UDP connection object.
  * @param[in] port Local port on which creation should be stablished.
  * @return new udp_connection object on success, NULL otherwise.
  * @remarks Function allocates resources that have to be freed with udp_communication_destroy.
+ * @remarks Incoming data is dispatched by the thread-default main context of the calling thread.
  */
 udp_connection_t *udp_connection_create(int port);
 
@@ -44,11 +83,40 @@ udp_connection_t *udp_connection_create(int port);
  * @param[in] connection UDP connection object.
  * @param[in] data Data to be sent.
  * @param[in] size Size in bytes of data pointed by data pointer.
- * @param[in] address IP address of receiver.
- * @param[in] port Port of receiver.
+ * @param[in] receiver Endpoint of receiver.
+ * @return 0 on success, -1 otherwise.
+ */
+int udp_connection_send(udp_connection_t *connection, const char *data, unsigned short int size, const endpoint_t *receiver);
+
+/**
+ * @brief Sends data to resolved destination.
+ * @param[in] connection UDP connection object.
+ * @param[in] data Data to be sent.
+ * @param[in] size Size in bytes of data pointed by data pointer.
+ * @param[in] destination Destination resolved with udp_destination_init.
+ * @return 0 on success, -1 otherwise.
+ * @remarks Data is sent with single non-blocking syscall, without any allocation.
+ */
+int udp_connection_send_to(udp_connection_t *connection, const char *data, unsigned short int size, const udp_destination_t *destination);
+
+/**
+ * @brief Queues data to be sent with the next flush.
+ * @param[in] connection UDP connection object.
+ * @param[in] data Data to be sent, it is copied.
+ * @param[in] size Size in bytes of data pointed by data pointer.
+ * @param[in] destination Destination resolved with udp_destination_init.
  * @return 0 on success, -1 otherwise.
+ * @remarks Queue is flushed automatically after udp_batch_end_cb returns and when
+ * it becomes full, so replies to a receive batch leave with single sendmmsg call.
  */
-int udp_connection_send(udp_connection_t *connection, const char *data, unsigned short int size, const char *address, int port);
+int udp_connection_queue(udp_connection_t *connection, const char *data, unsigned short int size, const udp_destination_t *destination);
+
+/**
+ * @brief Sends all queued data.
+ * @param[in] connection UDP connection object.
+ * @return 0 on success, -1 if any datagram could not be sent.
+ */
+int udp_connection_flush(udp_connection_t *connection);
 
 /**
  * @brief Sets callback for receiving data.
@@ -58,6 +126,30 @@ int udp_connection_send(udp_connection_t *connection, const char *data, unsigned
  */
 void udp_connection_set_receive_cb(udp_connection_t *connection, udp_receive_cb callback);
 
+/**
+ * @brief Sets callback called at the end of every receive batch.
+ * @param[in] connection UDP connection object.
+ * @param[in] callback Callback to be set or NULL to unregister.
+ */
+void udp_connection_set_batch_end_cb(udp_connection_t *connection, udp_batch_end_cb callback);
+
+/**
+ * @brief Sets maximal number of datagrams received in one wakeup.
+ * @param[in] connection UDP connection object.
+ * @param[in] batch_size Number of datagrams, 1 disables batched receive.
+ * @return 0 on success, -1 otherwise.
+ * @remarks For batch_size greater than 1 datagrams are read with single recvmmsg call
+ * into preallocated buffers and passed to receive callback in order of arrival.
+ */
+int udp_connection_set_batch_size(udp_connection_t *connection, unsigned int batch_size);
+
+/**
+ * @brief Gets receive and send counters of the connection.
+ * @param[in] connection UDP connection object.
+ * @param[out] stats Counters collected since connection creation.
+ */
+void udp_connection_get_stats(udp_connection_t *connection, udp_connection_stats_s *stats);
+
 /**
  * @brief Stops UDP communication and releases all resources allocated by udp_communication_create.
  * @param[in] connection UDP connection object.
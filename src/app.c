@@ -19,8 +19,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <math.h>
+#include <string.h>
 #include <glib.h>
+#include <glib-unix.h>
+#include <signal.h>
 #include <service_app.h>
 #include "log.h"
 #include "resource.h"
@@ -29,13 +31,29 @@
 #include "cloud/cloud_communication.h"
 #include "messages/message_manager.h"
 #include "controller_connection_manager.h"
+#include "control_thread.h"
 #include "command.h"
-
-#define ENABLE_MOTOR 1
+#include "car_control.h"
+#include "latency.h"
+#include "messages/clock.h"
 
 #define CONFIG_GRP_CAR "Car"
 #define CONFIG_KEY_ID "Id"
 #define CONFIG_KEY_NAME "Name"
+#define CONFIG_GRP_CONTROL "Control"
+#define CONFIG_KEY_RT_THREAD "RealtimeThread"
+#define CONFIG_KEY_RT_PRIORITY "Priority"
+#define CONFIG_KEY_RT_CPU "Cpu"
+#define CONFIG_KEY_LATENCY_DUMP_INTERVAL "LatencyDumpInterval"
+#define CONFIG_KEY_KEEP_ALIVE_TIMEOUT "KeepAliveTimeout"
+#define CONFIG_KEY_LINK_STATS_INTERVAL "LinkStatsInterval"
+#define CONFIG_KEY_FAILSAFE_TIMEOUT "FailsafeTimeout"
+#define CONFIG_KEY_FAILSAFE_DECELERATION "FailsafeDeceleration"
+#define CONFIG_GRP_LOG "Log"
+#define CONFIG_KEY_LOG_ASYNC "Async"
+#define CONFIG_KEY_LOG_LEVEL "Level"
+#define CONFIG_KEY_LOG_TYPE "Type"
+#define DEFAULT_RT_PRIORITY 50
 #define CLOUD_REQUESTS_FREQUENCY 15
 
 enum {
@@ -49,10 +67,17 @@ typedef struct app_data_s {
 	unsigned int r_value;
 	unsigned int dir_state;
 	guint idle_h;
+	guint latency_dump_h;
+	guint latency_signal_h;
 } app_data;
 
 static void _initialize_components(app_data *ad);
 static void _initialize_config();
+static void _control_components_init(void *data);
+static void _control_components_fini(void *data);
+
+static failsafe_config_s s_failsafe_config;
+static GSource *s_failsafe_source;
 
 static void service_app_lang_changed(app_event_info_h event_info, void *user_data)
 {
@@ -77,86 +102,130 @@ static void service_app_low_memory(app_event_info_h event_info, void *user_data)
 	return;
 }
 
-static inline double __map_round(double val)
+static gboolean __failsafe_cb(gpointer user_data)
 {
-	return floor(val + 0.5);
+	if (car_control_failsafe_check())
+		return TRUE;
+
+	g_source_unref(s_failsafe_source);
+	s_failsafe_source = NULL;
+	return FALSE;
 }
 
-static int __map_range_val(int d_max, int d_min, int v_max, int v_min, int val)
+static void _failsafe_watch(void)
 {
-	int rval = 0;
-	double slope = 0;
-	slope = 1.0 * (d_max - d_min) / (v_max - v_min);
-
-	rval = d_min + __map_round(slope * (val - v_min));
+	if (s_failsafe_source || !car_control_failsafe_is_active())
+		return;
 
-	return rval;
+	/* runs in the context commands are applied in, so no locking is needed */
+	s_failsafe_source = g_timeout_source_new(s_failsafe_config.step_ns / CLOCK_NS_PER_MS);
+	g_source_set_callback(s_failsafe_source, __failsafe_cb, NULL, NULL);
+	g_source_attach(s_failsafe_source, g_main_context_get_thread_default());
 }
 
-static int ___map_speed_val(int speed)
+static void _failsafe_unwatch(void)
 {
-	static const int motor_max = 4095;
-	static const int motor_min = -4095;
-	static const int speed_max = 1000;
-	static const int speed_min = -1000;
+	if (!s_failsafe_source)
+		return;
 
-	return __map_range_val(motor_max, motor_min,
-		speed_max, speed_min, speed);
+	g_source_destroy(s_failsafe_source);
+	g_source_unref(s_failsafe_source);
+	s_failsafe_source = NULL;
+}
+
+static void __command_received_cb(command_s command)
+{
+	car_control_apply(&command);
+	_failsafe_watch();
 }
 
-static int ___map_servo_val(int servo)
+static void __connection_state_cb(controller_connection_state_e previous, controller_connection_state_e current)
 {
-	static const int motor_max = 500;
-	static const int motor_min = 400;
-	static const int servo_max = 1000;
-	static const int servo_min = -1000;
+	if (current != CONTROLLER_CONNECTION_STATE_READY)
+		return;
 
-	return __map_range_val(motor_max, motor_min,
-		servo_max, servo_min, servo);
+	/* controller is gone, do not wait for the command deadline */
+	car_control_failsafe_trip();
+	_failsafe_watch();
 }
 
-static int __driving_motors(int servo, int speed)
+static void _apply_command(const command_s *command)
 {
-	int val_speed;
-	int val_servo;
+	if (control_thread_is_running()) {
+		control_thread_push_command(command);
+		return;
+	}
+	__command_received_cb(*command);
+}
 
-	val_servo = ___map_servo_val(servo);
-	val_speed = ___map_speed_val(speed);
+static void _control_components_init(void *data)
+{
+	int keep_alive_timeout = 0;
+	int link_stats_interval = 0;
+	int failsafe_timeout = 0;
+	int failsafe_deceleration = 0;
+
+	/* in milliseconds, minimal silence tolerated before motors ramp down */
+	failsafe_config_default(&s_failsafe_config);
+	if (!config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_FAILSAFE_TIMEOUT, &failsafe_timeout) && failsafe_timeout > 0)
+		s_failsafe_config.timeout_ns = failsafe_timeout * CLOCK_NS_PER_MS;
+	if (s_failsafe_config.max_timeout_ns < s_failsafe_config.timeout_ns)
+		s_failsafe_config.max_timeout_ns = s_failsafe_config.timeout_ns;
+	/* in speed units per second */
+	if (!config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_FAILSAFE_DECELERATION, &failsafe_deceleration) &&
+			failsafe_deceleration > 0)
+		s_failsafe_config.deceleration = failsafe_deceleration;
+	car_control_failsafe_init(&s_failsafe_config);
 
-	_D("control motor - servo[%4d : %4d], speed[%4d : %4d]",
-		servo, val_servo, speed, val_speed);
-#if ENABLE_MOTOR
-	resource_set_servo_motor_value(0, val_servo);
-	resource_set_motor_driver_L298N_speed(MOTOR_ID_1, val_speed);
-	resource_set_motor_driver_L298N_speed(MOTOR_ID_2, val_speed);
-#endif
+	message_manager_init();
+	controller_connection_manager_listen();
+	controller_connection_manager_set_command_received_cb(__command_received_cb);
+	controller_connection_manager_set_state_change_cb(__connection_state_cb);
+
+	/* in milliseconds, how fast the car gives up on silent controller */
+	if (!config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_KEEP_ALIVE_TIMEOUT, &keep_alive_timeout) && keep_alive_timeout > 0)
+		controller_connection_manager_set_keep_alive_timeout(keep_alive_timeout);
+	/* in milliseconds, 0 stops LINK_STATS messages */
+	if (!config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_LINK_STATS_INTERVAL, &link_stats_interval) && link_stats_interval >= 0)
+		controller_connection_manager_set_link_stats_interval(link_stats_interval);
+}
 
-	return 0;
+static void _control_components_fini(void *data)
+{
+	_failsafe_unwatch();
+	controller_connection_manager_release();
+	message_manager_shutdown();
 }
 
-static void __camera(int azimuth, int elevation)
+static void _start_control(void)
 {
-	//TODO: Camera steering
+	bool rt_thread = false;
+	control_thread_config_s config = {
+		.priority = DEFAULT_RT_PRIORITY,
+		.cpu = -1,
+	};
+
+	config_get_bool(CONFIG_GRP_CONTROL, CONFIG_KEY_RT_THREAD, &rt_thread);
+	if (rt_thread) {
+		config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_RT_PRIORITY, &config.priority);
+		config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_RT_CPU, &config.cpu);
+		if (!control_thread_start(&config, _control_components_init, _control_components_fini,
+				__command_received_cb, NULL)) {
+			return;
+		}
+		_E("Failed to start control thread, falling back to main loop");
+	}
+
+	_control_components_init(NULL);
 }
 
-static void __command_received_cb(command_s command) {
-	switch(command.type) {
-	case COMMAND_TYPE_DRIVE:
-		__driving_motors(command.data.steering.direction, command.data.steering.speed);
-		break;
-	case COMMAND_TYPE_CAMERA:
-		__camera(command.data.camera_position.camera_azimuth, command.data.camera_position.camera_elevation);
-		break;
-	case COMMAND_TYPE_DRIVE_AND_CAMERA:
-		__driving_motors(command.data.steering_and_camera.direction, command.data.steering_and_camera.speed);
-		__camera(command.data.steering_and_camera.camera_azimuth, command.data.steering_and_camera.camera_elevation);
-		break;
-	case COMMAND_TYPE_NONE:
-		break;
-	default:
-		_E("Unknown command type");
-		break;
+static void _stop_control(void)
+{
+	if (control_thread_is_running()) {
+		control_thread_stop();
+		return;
 	}
+	_control_components_fini(NULL);
 }
 
 static void _initialize_config()
@@ -183,13 +252,96 @@ static void _initialize_config()
 	free(name);
 }
 
+static gboolean _latency_dump_cb(gpointer user_data)
+{
+	latency_dump();
+	return TRUE;
+}
+
+static void _start_latency_reporting(app_data *ad)
+{
+	int interval = 0;
+
+	/* on demand with "kill -USR1", periodically if interval in seconds is configured */
+	ad->latency_signal_h = g_unix_signal_add(SIGUSR1, _latency_dump_cb, NULL);
+
+	config_get_int(CONFIG_GRP_CONTROL, CONFIG_KEY_LATENCY_DUMP_INTERVAL, &interval);
+	if (interval > 0)
+		ad->latency_dump_h = g_timeout_add_seconds(interval, _latency_dump_cb, NULL);
+}
+
+static void _stop_latency_reporting(app_data *ad)
+{
+	if (ad->latency_dump_h) {
+		g_source_remove(ad->latency_dump_h);
+		ad->latency_dump_h = 0;
+	}
+	if (ad->latency_signal_h) {
+		g_source_remove(ad->latency_signal_h);
+		ad->latency_signal_h = 0;
+	}
+	latency_dump();
+}
+
+static void _initialize_logging(void)
+{
+	static const char *level_names[DLOG_PRIO_MAX] = {
+		[DLOG_VERBOSE] = "VERBOSE",
+		[DLOG_DEBUG] = "DEBUG",
+		[DLOG_INFO] = "INFO",
+		[DLOG_WARN] = "WARN",
+		[DLOG_ERROR] = "ERROR",
+		[DLOG_FATAL] = "FATAL",
+	};
+	static const char *type_names[] = {
+		[LOG_TYPE_DLOG] = "DLOG",
+		[LOG_TYPE_FILE] = "FILE",
+		[LOG_TYPE_ALL] = "ALL",
+		[LOG_TYPE_BINARY] = "BINARY",
+	};
+	bool async = false;
+	char *level = NULL;
+	char *type = NULL;
+	int i;
+
+	/* BINARY enables flight recorder in log.bin, decoded by blog-decode */
+	if (!config_get_string(CONFIG_GRP_LOG, CONFIG_KEY_LOG_TYPE, &type)) {
+		for (i = 0; i < (int)(sizeof(type_names) / sizeof(type_names[0])); i++) {
+			if (!strcmp(type_names[i], type)) {
+				log_type_set(i);
+				break;
+			}
+		}
+		if (i == (int)(sizeof(type_names) / sizeof(type_names[0])))
+			_W("Unknown log type %s", type);
+		free(type);
+	}
+
+	if (!config_get_string(CONFIG_GRP_LOG, CONFIG_KEY_LOG_LEVEL, &level)) {
+		for (i = 0; i < DLOG_PRIO_MAX; i++) {
+			if (level_names[i] && !strcmp(level_names[i], level)) {
+				log_level_set(i);
+				break;
+			}
+		}
+		if (i == DLOG_PRIO_MAX)
+			_W("Unknown log level %s", level);
+		free(level);
+	}
+
+	config_get_bool(CONFIG_GRP_LOG, CONFIG_KEY_LOG_ASYNC, &async);
+	if (async && log_async_start(0))
+		_E("Failed to start async logging");
+}
+
 static void _initialize_components(app_data *ad)
 {
 	net_util_init();
 	_initialize_config();
+	_initialize_logging();
 	cloud_communication_init();
-	message_manager_init();
-	controller_connection_manager_listen();
+	_start_latency_reporting(ad);
+	_start_control();
 }
 
 static bool service_app_create(void *data)
@@ -218,20 +370,18 @@ static bool service_app_create(void *data)
 	_initialize_components(ad);
 	cloud_communication_start(CLOUD_REQUESTS_FREQUENCY);
 
-	controller_connection_manager_set_command_received_cb(__command_received_cb);
-
 	return true;
 }
 
 static void service_app_control(app_control_h app_control, void *data)
 {
-
-#if ENABLE_MOTOR
 	/* set speed 0, to reduce delay of initializing motor driver */
-	resource_set_motor_driver_L298N_speed(MOTOR_ID_1, 0);
-	resource_set_motor_driver_L298N_speed(MOTOR_ID_2, 0);
-	resource_set_servo_motor_value(0, 450);
-#endif
+	command_s neutral = {
+		.type = COMMAND_TYPE_DRIVE,
+		.data.steering = { .speed = 0, .direction = 0 },
+	};
+
+	_apply_command(&neutral);
 
 	return;
 }
@@ -244,8 +394,8 @@ static void service_app_terminate(void *data)
 		g_source_remove(ad->idle_h);
 
 
-	controller_connection_manager_release();
-	message_manager_shutdown();
+	_stop_control();
+	_stop_latency_reporting(ad);
 
 	cloud_communication_stop();
 	cloud_communication_fini();
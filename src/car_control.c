@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include "car_control.h"
+#include "log.h"
+#include "latency.h"
+#include "resource.h"
+#include "failsafe.h"
+#include "messages/clock.h"
+
+static failsafe_t s_failsafe;
+static bool s_failsafe_enabled;
+
+static inline double __map_round(double val)
+{
+	return floor(val + 0.5);
+}
+
+static int __map_range_val(int d_max, int d_min, int v_max, int v_min, int val)
+{
+	int rval = 0;
+	double slope = 0;
+	slope = 1.0 * (d_max - d_min) / (v_max - v_min);
+
+	rval = d_min + __map_round(slope * (val - v_min));
+
+	return rval;
+}
+
+static int ___map_speed_val(int speed)
+{
+	static const int motor_max = 4095;
+	static const int motor_min = -4095;
+	static const int speed_max = 1000;
+	static const int speed_min = -1000;
+
+	return __map_range_val(motor_max, motor_min,
+		speed_max, speed_min, speed);
+}
+
+static int ___map_servo_val(int servo)
+{
+	static const int motor_max = 500;
+	static const int motor_min = 400;
+	static const int servo_max = 1000;
+	static const int servo_min = -1000;
+
+	return __map_range_val(motor_max, motor_min,
+		servo_max, servo_min, servo);
+}
+
+static int __driving_motors(int servo, int speed)
+{
+	int val_speed;
+	int val_servo;
+
+	val_servo = ___map_servo_val(servo);
+	val_speed = ___map_speed_val(speed);
+	latency_trace_mark(LATENCY_POINT_MAPPED);
+
+	_D("control motor - servo[%4d : %4d], speed[%4d : %4d]",
+		servo, val_servo, speed, val_speed);
+#if ENABLE_MOTOR
+	resource_set_servo_motor_value(0, val_servo);
+	resource_set_motor_driver_L298N_speed(MOTOR_ID_1, val_speed);
+	resource_set_motor_driver_L298N_speed(MOTOR_ID_2, val_speed);
+#endif
+	latency_trace_mark(LATENCY_POINT_ACTUATED);
+
+	return 0;
+}
+
+static void __camera(int azimuth, int elevation)
+{
+	//TODO: Camera steering
+}
+
+void car_control_apply(const command_s *command)
+{
+	if (s_failsafe_enabled)
+		failsafe_command(&s_failsafe, command, clock_monotonic_ns_get());
+
+	switch(command->type) {
+	case COMMAND_TYPE_DRIVE:
+		__driving_motors(command->data.steering.direction, command->data.steering.speed);
+		break;
+	case COMMAND_TYPE_CAMERA:
+		__camera(command->data.camera_position.camera_azimuth, command->data.camera_position.camera_elevation);
+		break;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		__driving_motors(command->data.steering_and_camera.direction, command->data.steering_and_camera.speed);
+		__camera(command->data.steering_and_camera.camera_azimuth, command->data.steering_and_camera.camera_elevation);
+		break;
+	case COMMAND_TYPE_NONE:
+		break;
+	default:
+		_E("Unknown command type");
+		break;
+	}
+
+	latency_trace_end();
+}
+
+void car_control_failsafe_init(const failsafe_config_s *config)
+{
+	failsafe_init(&s_failsafe, config);
+	s_failsafe_enabled = true;
+}
+
+bool car_control_failsafe_is_active(void)
+{
+	return s_failsafe_enabled && failsafe_is_active(&s_failsafe);
+}
+
+void car_control_failsafe_trip(void)
+{
+	if (s_failsafe_enabled)
+		failsafe_trip(&s_failsafe, clock_monotonic_ns_get());
+}
+
+bool car_control_failsafe_check(void)
+{
+	int speed = 0;
+	int direction = 0;
+
+	if (!s_failsafe_enabled)
+		return false;
+
+	switch (failsafe_poll(&s_failsafe, clock_monotonic_ns_get(), &speed, &direction)) {
+	case FAILSAFE_ACTION_DECAY:
+		_D("failsafe - speed decayed to [%4d]", speed);
+		__driving_motors(direction, speed);
+		break;
+	case FAILSAFE_ACTION_BRAKE:
+		_W("No commands from controller, motors stopped");
+		/* zero speed brakes the motors in the driver */
+		__driving_motors(s_failsafe.direction, 0);
+		break;
+	case FAILSAFE_ACTION_NONE:
+		break;
+	}
+
+	return failsafe_is_active(&s_failsafe);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "connection_table.h"
+
+#include <string.h>
+
+#define SLOT_MASK (CONNECTION_TABLE_SLOTS - 1)
+#define SLOT_EMPTY -1
+
+static inline unsigned int _home_slot(const endpoint_t *endpoint)
+{
+	return endpoint_hash(endpoint) & SLOT_MASK;
+}
+
+void connection_table_init(connection_table_t *table)
+{
+	memset(table, 0x0, sizeof(*table));
+	memset(table->slots, SLOT_EMPTY, sizeof(table->slots));
+}
+
+static int _find_slot(const connection_table_t *table, const endpoint_t *endpoint)
+{
+	unsigned int slot = _home_slot(endpoint);
+	unsigned int probes;
+	int index;
+
+	for (probes = 0; probes < CONNECTION_TABLE_SLOTS; probes++, slot = (slot + 1) & SLOT_MASK) {
+		index = table->slots[slot];
+		if (index == SLOT_EMPTY)
+			return -1;
+		if (endpoint_equal(&table->entries[index].endpoint, endpoint))
+			return slot;
+	}
+
+	return -1;
+}
+
+int connection_table_find(const connection_table_t *table, const endpoint_t *endpoint)
+{
+	int slot = _find_slot(table, endpoint);
+
+	return slot < 0 ? -1 : table->slots[slot];
+}
+
+int connection_table_add(connection_table_t *table, const endpoint_t *endpoint, message_role_e role)
+{
+	unsigned int slot;
+	int index;
+
+	if (table->count == CONNECTION_TABLE_CAPACITY || _find_slot(table, endpoint) >= 0)
+		return -1;
+
+	for (index = 0; table->entries[index].used; index++)
+		;
+
+	/* table is at most half full, so there is always an empty slot */
+	for (slot = _home_slot(endpoint); table->slots[slot] != SLOT_EMPTY; slot = (slot + 1) & SLOT_MASK)
+		;
+
+	table->slots[slot] = index;
+	table->entries[index].endpoint = *endpoint;
+	table->entries[index].role = role;
+	table->entries[index].used = true;
+	table->count++;
+	return index;
+}
+
+void connection_table_remove(connection_table_t *table, int index)
+{
+	int hole = _find_slot(table, &table->entries[index].endpoint);
+	unsigned int slot, home;
+
+	if (hole < 0 || table->slots[hole] != index)
+		return;
+
+	/* backward shift deletion keeps probe sequences without tombstones */
+	for (slot = (hole + 1) & SLOT_MASK; table->slots[slot] != SLOT_EMPTY; slot = (slot + 1) & SLOT_MASK) {
+		home = _home_slot(&table->entries[table->slots[slot]].endpoint);
+		if (((slot - home) & SLOT_MASK) < ((slot - hole) & SLOT_MASK))
+			continue;
+		table->slots[hole] = table->slots[slot];
+		hole = slot;
+	}
+
+	table->slots[hole] = SLOT_EMPTY;
+	memset(&table->entries[index], 0x0, sizeof(table->entries[index]));
+	table->count--;
+}
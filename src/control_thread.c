@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _GNU_SOURCE
+#include "control_thread.h"
+#include <glib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "spsc_queue.h"
+#include "log.h"
+
+#define COMMAND_QUEUE_SIZE 32
+
+typedef struct _control_thread_info {
+	GThread *thread;
+	GMainContext *context;
+	GMainLoop *loop;
+	GSource *command_source;
+	spsc_queue_t commands;
+	int stopping;
+	control_thread_config_s config;
+	control_thread_cb init_cb;
+	control_thread_cb fini_cb;
+	control_thread_command_cb command_cb;
+	void *user_data;
+} _control_thread_info_s;
+
+static _control_thread_info_s s_info;
+
+static gboolean _command_source_check(GSource *source)
+{
+	return !spsc_queue_is_empty(&s_info.commands) || __atomic_load_n(&s_info.stopping, __ATOMIC_ACQUIRE);
+}
+
+static gboolean _command_source_prepare(GSource *source, gint *timeout)
+{
+	*timeout = -1;
+	return _command_source_check(source);
+}
+
+static gboolean _command_source_dispatch(GSource *source, GSourceFunc callback, gpointer data)
+{
+	command_s command;
+
+	while (!spsc_queue_pop(&s_info.commands, &command)) {
+		if (s_info.command_cb)
+			s_info.command_cb(command);
+	}
+
+	if (__atomic_load_n(&s_info.stopping, __ATOMIC_ACQUIRE))
+		g_main_loop_quit(s_info.loop);
+
+	return TRUE;
+}
+
+static GSourceFuncs _command_source_funcs = {
+	.prepare = _command_source_prepare,
+	.check = _command_source_check,
+	.dispatch = _command_source_dispatch,
+};
+
+static void _apply_scheduling(const control_thread_config_s *config)
+{
+	struct sched_param param = { .sched_priority = config->priority };
+	cpu_set_t cpus;
+	int ret;
+
+	if (config->priority > 0) {
+		ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (ret)
+			_W("Failed to set SCHED_FIFO priority %d: %s", config->priority, strerror(ret));
+		else
+			_I("Control thread runs with SCHED_FIFO priority %d", config->priority);
+	}
+
+	if (config->cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(config->cpu, &cpus);
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (ret)
+			_W("Failed to pin control thread to CPU %d: %s", config->cpu, strerror(ret));
+		else
+			_I("Control thread pinned to CPU %d", config->cpu);
+	}
+}
+
+static gpointer _control_thread_main(gpointer data)
+{
+	_apply_scheduling(&s_info.config);
+
+	g_main_context_push_thread_default(s_info.context);
+
+	if (s_info.init_cb)
+		s_info.init_cb(s_info.user_data);
+
+	g_main_loop_run(s_info.loop);
+
+	if (s_info.fini_cb)
+		s_info.fini_cb(s_info.user_data);
+
+	g_main_context_pop_thread_default(s_info.context);
+	return NULL;
+}
+
+static void _release_resources()
+{
+	if (s_info.command_source) {
+		g_source_destroy(s_info.command_source);
+		g_source_unref(s_info.command_source);
+	}
+	if (s_info.loop)
+		g_main_loop_unref(s_info.loop);
+	if (s_info.context)
+		g_main_context_unref(s_info.context);
+	spsc_queue_shutdown(&s_info.commands);
+	memset(&s_info, 0x0, sizeof(s_info));
+}
+
+int control_thread_start(const control_thread_config_s *config, control_thread_cb init_cb, control_thread_cb fini_cb,
+		control_thread_command_cb command_cb, void *user_data)
+{
+	GError *error = NULL;
+
+	retvm_if(s_info.thread, -1, "Control thread is already running");
+
+	if (spsc_queue_init(&s_info.commands, COMMAND_QUEUE_SIZE, sizeof(command_s))) {
+		_E("Failed to create command queue");
+		return -1;
+	}
+
+	s_info.config = *config;
+	s_info.init_cb = init_cb;
+	s_info.fini_cb = fini_cb;
+	s_info.command_cb = command_cb;
+	s_info.user_data = user_data;
+
+	s_info.context = g_main_context_new();
+	s_info.loop = g_main_loop_new(s_info.context, FALSE);
+	s_info.command_source = g_source_new(&_command_source_funcs, sizeof(GSource));
+	g_source_set_priority(s_info.command_source, G_PRIORITY_HIGH);
+	g_source_attach(s_info.command_source, s_info.context);
+
+	s_info.thread = g_thread_try_new("control", _control_thread_main, NULL, &error);
+	if (!s_info.thread) {
+		_E("Failed to create control thread: %s", error->message);
+		g_error_free(error);
+		_release_resources();
+		return -1;
+	}
+
+	return 0;
+}
+
+int control_thread_push_command(const command_s *command)
+{
+	if (!s_info.thread)
+		return -1;
+
+	if (spsc_queue_push(&s_info.commands, command)) {
+		_W("Control thread command queue is full");
+		return -1;
+	}
+
+	g_main_context_wakeup(s_info.context);
+	return 0;
+}
+
+bool control_thread_is_running()
+{
+	return s_info.thread != NULL;
+}
+
+void control_thread_stop()
+{
+	if (!s_info.thread)
+		return;
+
+	__atomic_store_n(&s_info.stopping, 1, __ATOMIC_RELEASE);
+	g_main_context_wakeup(s_info.context);
+	g_thread_join(s_info.thread);
+	_release_resources();
+}
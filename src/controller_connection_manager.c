@@ -16,71 +16,181 @@
 
 #include "controller_connection_manager.h"
 #include "messages/message_manager.h"
-#include "messages/message_command.h"
 #include "messages/message_ack.h"
-#include "messages/message_factory.h"
+#include "messages/message_pool.h"
 #include <string.h>
 #include <glib.h>
 #include "log.h"
+#include "latency.h"
 #include "assert.h"
+#include "timer_wheel.h"
+#include "serial_window.h"
+#include "connection_table.h"
+#include "messages/clock.h"
 
-#define KEEP_ALIVE_CHECK_ATTEMPTS 5
 #define HELLO_ACCEPT_ATTEMPTS 5
 #define HELLO_ACCEPT_INTERVAL 1000 //In ms
-#define KEEP_ALIVE_CHECK_INTERVAL 1000 //In ms
+#define KEEP_ALIVE_TIMEOUT 5000 //In ms
+#define TIMER_TICK 10 //In ms
+#define LINK_STATS_INTERVAL 1000 //In ms
+#define MAX_OBSERVERS (CONNECTION_TABLE_CAPACITY - 1) //One session is kept for the driver
 
-#define SAFE_SOURCE_REMOVE(source)\
-do { \
-	if(source) { \
-		g_source_remove(source); \
-	} \
-	source = 0; \
-} while(0)
+typedef struct _timer_source {
+	GSource source;
+	timer_wheel_t *wheel;
+} _timer_source_s;
+
+typedef struct _observer {
+	timer_wheel_timer_t keep_alive_timer;
+	int64_t last_alive_ns;
+} _observer_s;
 
 typedef struct _controller_connection_manager_info {
 	controller_connection_state_e state;
-	char *controller_address;
-	int controller_port;
+	endpoint_t controller;
 	connection_state_cb state_cb;
 	command_received_cb command_cb;
-	int keep_alive_check_attempts_left;
 	int connect_accept_attempts_left;
-	guint connect_accept_timer;
-	guint keep_alive_check_timer;
-	unsigned long long int last_serial;
-	message_factory_t *message_factory;
+	timer_wheel_t timers;
+	GSource *timer_source;
+	timer_wheel_timer_t connect_accept_timer;
+	timer_wheel_timer_t keep_alive_timer;
+	timer_wheel_timer_t link_stats_timer;
+	int64_t keep_alive_timeout_ns;
+	int64_t last_alive_ns; /* last time controller was heard from */
+	serial_window_t serials; /* serials of the controller session */
+	int64_t last_keep_alive_serial;
+	int64_t last_command_serial; /* serial of the last applied COMMAND */
+	message_wire_version_e wire_version;
+	message_pool_t *message_pool;
+	message_prebuilt_t connect_refused;
+	message_prebuilt_t connect_accepted;
+	link_stats_t link_stats;
+	int64_t link_stats_interval_ns;
+	int64_t link_stats_serial; /* LINK_STATS waiting for ACK, -1 if none */
+	int64_t link_stats_sent_ns;
+	connection_table_t sessions; /* driver and observers */
+	_observer_s observers[CONNECTION_TABLE_CAPACITY]; /* indexed as sessions */
+	endpoint_t observer_endpoints[MAX_OBSERVERS]; /* receivers of telemetry */
+	unsigned int observer_count;
+	message_prebuilt_t observer_accepted;
 } _controller_connection_manager_s;
 
 static _controller_connection_manager_s s_info = {
 	.state = CONTROLLER_CONNECTION_STATE_READY,
-	.controller_address = NULL,
+	.controller = {0, },
 	.state_cb = NULL,
-	.keep_alive_check_attempts_left = KEEP_ALIVE_CHECK_ATTEMPTS,
 	.connect_accept_attempts_left = HELLO_ACCEPT_ATTEMPTS,
-	.connect_accept_timer = 0,
-	.keep_alive_check_timer = 0
+	.timer_source = NULL,
+	.keep_alive_timeout_ns = KEEP_ALIVE_TIMEOUT * CLOCK_NS_PER_MS,
+	.link_stats_interval_ns = LINK_STATS_INTERVAL * CLOCK_NS_PER_MS,
+	.link_stats_serial = -1,
+	.wire_version = MESSAGE_WIRE_V1
 };
 
-static int _try_connect(const char *ip, int port);
+static int _try_connect(const endpoint_t *controller, message_wire_version_e peer_version);
 static void _disconnect();
 static void _set_state(controller_connection_state_e state);
-static void _receive_cb(message_t *message, void *data);
+static void _receive_cb(const message_view_t *message, void *data);
+static bool _receive_filter_cb(const message_view_t *message, void *data);
 static void _reset_counters();
 static gboolean _send_connect_accept();
-static gboolean _connect_accept_timer_cb(gpointer data);
-static gboolean _keep_alive_check_timer_cb(gpointer data);
-static int _addr_cmp(const char *addr1, int port1, const char *addr2, int port2);
+static void _send_ack(const endpoint_t *receiver, int64_t serial);
+static void _mark_alive();
+static void _connect_accept_timer_cb(timer_wheel_timer_t *timer, void *data);
+static void _keep_alive_timer_cb(timer_wheel_timer_t *timer, void *data);
+static void _link_stats_timer_cb(timer_wheel_timer_t *timer, void *data);
+static void _link_stats_received(const message_view_t *message);
+static void _drop_repeated(const message_view_t *message, serial_window_result_e order);
+static int32_t _to_us(int64_t ns);
+static void _try_observe(const endpoint_t *observer);
+static void _handle_observer_message(int session, const message_view_t *message);
+static void _remove_observer(int session);
+static void _update_observer_endpoints();
+static void _observer_timer_cb(timer_wheel_timer_t *timer, void *data);
+static GSource *_timer_source_new(timer_wheel_t *wheel);
 
 int controller_connection_manager_listen()
 {
-	s_info.message_factory = message_factory_create();
-	if(!s_info.message_factory) {
+	s_info.message_pool = message_pool_create();
+	if(!s_info.message_pool) {
+		return -1;
+	}
+	if(message_prebuilt_init(&s_info.connect_refused, message_pool_get(s_info.message_pool, MESSAGE_CONNECT_REFUSED))) {
+		_E("Failed to build CONNECT_REFUSED message");
+		message_pool_destroy(s_info.message_pool);
+		s_info.message_pool = NULL;
+		return -1;
+	}
+
+	message_connect_accepted_t *accepted = message_pool_get_connect_accepted(s_info.message_pool);
+	accepted->role = MESSAGE_ROLE_OBSERVER;
+	if(message_prebuilt_init(&s_info.observer_accepted, &accepted->base)) {
+		_E("Failed to build CONNECT_ACCEPTED message for observers");
+		message_pool_destroy(s_info.message_pool);
+		s_info.message_pool = NULL;
 		return -1;
 	}
+
+	connection_table_init(&s_info.sessions);
+	s_info.observer_count = 0;
+
+	timer_wheel_init(&s_info.timers, TIMER_TICK * CLOCK_NS_PER_MS, clock_monotonic_ns_get());
+	for(int i = 0; i < CONNECTION_TABLE_CAPACITY; i++) {
+		timer_wheel_timer_init(&s_info.observers[i].keep_alive_timer, _observer_timer_cb, &s_info.observers[i]);
+	}
+	timer_wheel_timer_init(&s_info.connect_accept_timer, _connect_accept_timer_cb, NULL);
+	timer_wheel_timer_init(&s_info.keep_alive_timer, _keep_alive_timer_cb, NULL);
+	timer_wheel_timer_init(&s_info.link_stats_timer, _link_stats_timer_cb, NULL);
+	s_info.timer_source = _timer_source_new(&s_info.timers);
+
 	message_manager_set_receive_message_cb(_receive_cb, NULL);
+	message_manager_set_receive_filter_cb(_receive_filter_cb, NULL);
+	return 0;
+}
+
+void controller_connection_manager_set_keep_alive_timeout(unsigned int timeout_ms)
+{
+	if(!timeout_ms) {
+		_W("Keep alive timeout has to be positive");
+		return;
+	}
+	s_info.keep_alive_timeout_ns = timeout_ms * CLOCK_NS_PER_MS;
+}
+
+void controller_connection_manager_set_link_stats_interval(unsigned int interval_ms)
+{
+	s_info.link_stats_interval_ns = interval_ms * CLOCK_NS_PER_MS;
+	if(!s_info.link_stats_interval_ns) {
+		timer_wheel_cancel(&s_info.timers, &s_info.link_stats_timer);
+	} else if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && !timer_wheel_timer_is_scheduled(&s_info.link_stats_timer)) {
+		timer_wheel_schedule(&s_info.timers, &s_info.link_stats_timer, clock_monotonic_ns_get() + s_info.link_stats_interval_ns);
+	}
+}
+
+int controller_connection_manager_get_link_stats(link_stats_summary_s *stats)
+{
+	if(s_info.state != CONTROLLER_CONNECTION_STATE_RESERVED) {
+		return -1;
+	}
+	link_stats_get_summary(&s_info.link_stats, stats);
+	return 0;
+}
+
+int controller_connection_manager_get_serial_stats(serial_window_stats_s *stats)
+{
+	if(s_info.state != CONTROLLER_CONNECTION_STATE_RESERVED) {
+		return -1;
+	}
+	*stats = *serial_window_get_stats(&s_info.serials);
 	return 0;
 }
 
+unsigned int controller_connection_manager_get_observer_count()
+{
+	return s_info.observer_count;
+}
+
 controller_connection_state_e controller_connection_manager_get_state()
 {
 	return s_info.state;
@@ -96,75 +206,123 @@ void controller_connection_manager_set_command_received_cb(command_received_cb c
 	s_info.command_cb = callback;
 }
 
-void controller_connection_manager_handle_message(message_t *message)
+void controller_connection_manager_handle_message(const message_view_t *message)
 {
-	if(!s_info.message_factory) {
-		_E("Message factory not initialized");
+	if(!s_info.message_pool) {
+		_E("Message pool not initialized");
 		return;
 	}
-	const char *msg_address;
-	int msg_port;
-	message_get_sender(message, &msg_address, &msg_port);
-	int address_match = !_addr_cmp(s_info.controller_address, s_info.controller_port, msg_address, msg_port);
+	char address_str[ENDPOINT_STR_LEN];
+	const endpoint_t *sender = message_view_get_sender(message);
+	int address_match = endpoint_equal(&s_info.controller, sender);
 
-	switch(message_get_type(message)) {
-	case MESSAGE_CONNECT:
-		if(s_info.state == CONTROLLER_CONNECTION_STATE_READY) {
-			if(_try_connect(msg_address, msg_port)) {
+	/* driver is matched first, so observers add no lookups to its messages */
+	if(!address_match && s_info.observer_count) {
+		int session = connection_table_find(&s_info.sessions, sender);
+		if(session >= 0) {
+			_handle_observer_message(session, message);
+			return;
+		}
+	}
+
+	switch(message_view_get_type(message)) {
+	case MESSAGE_CONNECT: {
+		message_role_e role;
+		if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && address_match) {
+			/* driver never gets refused, whatever role it asks for now;
+			 * previous CONNECT_ACCEPTED could be lost */
+			message_manager_send_prebuilt(&s_info.connect_accepted, sender);
+		} else if(message_view_get_peer_role(message, &role) == 0 && role == MESSAGE_ROLE_OBSERVER) {
+			_try_observe(sender);
+		} else if(s_info.state == CONTROLLER_CONNECTION_STATE_READY) {
+			message_wire_version_e peer_version;
+			if(message_view_get_peer_version(message, &peer_version)) {
+				peer_version = MESSAGE_WIRE_V1;
+			}
+			if(_try_connect(sender, peer_version)) {
 				_E("Received CONNECT, but cannot establish connection");
 			} else {
-				s_info.last_serial = message_get_serial(message);
-				_I("Established connection with %s:%d", s_info.controller_address, s_info.controller_port);
+				serial_window_update(&s_info.serials, message_view_get_serial(message));
+				s_info.last_keep_alive_serial = message_view_get_serial(message);
+				s_info.last_command_serial = message_view_get_serial(message);
+				link_stats_received(&s_info.link_stats, message_view_get_serial(message));
+				_I("Established connection with %s (wire v%d)", endpoint_to_string(&s_info.controller, address_str, sizeof(address_str)), s_info.wire_version);
 			}
-		} else {
-			message_t *response = message_factory_create_message(s_info.message_factory, MESSAGE_CONNECT_REFUSED);
-			if(!response) {
-				_W("Failed to create CONNECT_REFUSED message");
-				break;
-			}
-			message_set_receiver(response, msg_address, msg_port);
-			message_manager_send_message(response);
-			message_destroy(response);
+		} else if(message_manager_send_prebuilt(&s_info.connect_refused, sender)) {
+			_W("Failed to send CONNECT_REFUSED message");
 		}
 		break;
+	}
 	case MESSAGE_KEEP_ALIVE:
 		if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && address_match) {
-			unsigned long long int serial = message_get_serial(message);
-			if(serial > s_info.last_serial) {
-				SAFE_SOURCE_REMOVE(s_info.connect_accept_timer);
-				s_info.keep_alive_check_attempts_left = KEEP_ALIVE_CHECK_ATTEMPTS;
-				message_ack_t response;
-				message_ack_init_from_request(&response, message);
-				message_set_receiver((message_t*)&response, s_info.controller_address, s_info.controller_port);
-				message_manager_send_message((message_t*)&response);
-				message_destroy((message_t*)&response);
-				s_info.last_serial = serial;
+			int64_t serial = message_view_get_serial(message);
+			if(serial > s_info.last_keep_alive_serial) {
+				timer_wheel_cancel(&s_info.timers, &s_info.connect_accept_timer);
+				_mark_alive();
+				if(!message->in_batch) {
+					_send_ack(&s_info.controller, serial);
+				}
+				s_info.last_keep_alive_serial = serial;
 			} else {
-				_W("Received late KEEP_ALIVE (%d, when last is %d)", serial, s_info.last_serial);
+				_W("Received late KEEP_ALIVE (%lld, when last is %lld)", (long long)serial, (long long)s_info.last_keep_alive_serial);
 			}
 		} else {
-			_W("Unexpectedly received KEEP_ALIVE from %s:%d (address_match == %d)", msg_address, msg_port, address_match);
+			_W("Unexpectedly received KEEP_ALIVE from %s (address_match == %d)", endpoint_to_string(sender, address_str, sizeof(address_str)), address_match);
 		}
 		break;
 	case MESSAGE_COMMAND:
 		if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && address_match) {
-			const command_s *command = message_command_get_command((message_command_t *) message);
-			if(!command) {
+			command_s command;
+			if(message_view_get_command(message, &command)) {
 				_E("Failed to obtain command");
 				break;
 			}
+			_mark_alive();
+			/* commands are handled when the receive batch ends, so they are
+			 * ordered only against the last applied one, not other messages */
+			if(message_view_get_serial(message) <= s_info.last_command_serial) {
+				_W_RL(1, "Dropped late COMMAND (%lld, when last is %lld)", (long long)message_view_get_serial(message), (long long)s_info.last_command_serial);
+				break;
+			}
+			s_info.last_command_serial = message_view_get_serial(message);
 			if(s_info.command_cb) {
-				s_info.command_cb(*command);
+				latency_trace_mark(LATENCY_POINT_DISPATCHED);
+				s_info.command_cb(command);
+			}
+			if(s_info.observer_count) {
+				/* queued after the command was applied, sent with other replies of the batch */
+				message_command_t *telemetry = message_pool_get_command(s_info.message_pool);
+				telemetry->command = command;
+				message_manager_send_message_to_all(&telemetry->base, s_info.observer_endpoints, s_info.observer_count);
 			}
 		} else {
-			_W("Unexpectedly received COMMAND from %s:%d (address_match == %d)", msg_address, msg_port, address_match);
+			_W("Unexpectedly received COMMAND from %s (address_match == %d)", endpoint_to_string(sender, address_str, sizeof(address_str)), address_match);
+		}
+		break;
+	case MESSAGE_ACK:
+		if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && address_match) {
+			int64_t ack_serial;
+			/* only the latest LINK_STATS is timed, like Karn's algorithm does */
+			if(!message_view_get_ack_serial(message, &ack_serial) && ack_serial == s_info.link_stats_serial) {
+				link_stats_rtt_sample(&s_info.link_stats, clock_monotonic_ns_get() - s_info.link_stats_sent_ns);
+				s_info.link_stats_serial = -1;
+			}
 		}
 		break;
 	case MESSAGE_BYE:
 		if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && address_match) {
 			_disconnect();
 		} else {
-			_W("Unexpectedly received BYE from %s:%d (address_match == %d)", msg_address, msg_port, address_match);
+			_W("Unexpectedly received BYE from %s (address_match == %d)", endpoint_to_string(sender, address_str, sizeof(address_str)), address_match);
+		}
+		break;
+	case MESSAGE_BATCH:
+		if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED && address_match) {
+			/* sub-messages were already handled, one ACK confirms all of them */
+			_mark_alive();
+			_send_ack(&s_info.controller, message_view_get_serial(message));
+		} else {
+			_W("Unexpectedly received BATCH from %s (address_match == %d)", endpoint_to_string(sender, address_str, sizeof(address_str)), address_match);
 		}
 		break;
 	default:
@@ -177,9 +335,19 @@ void controller_connection_manager_release()
 	if(s_info.state == CONTROLLER_CONNECTION_STATE_RESERVED) {
 		_disconnect();
 	}
-	message_factory_destroy(s_info.message_factory);
+	for(int i = 0; i < CONNECTION_TABLE_CAPACITY; i++) {
+		if(connection_table_get(&s_info.sessions, i)->used) {
+			_remove_observer(i);
+		}
+	}
+	if(s_info.timer_source) {
+		g_source_destroy(s_info.timer_source);
+		g_source_unref(s_info.timer_source);
+		s_info.timer_source = NULL;
+	}
+	message_pool_destroy(s_info.message_pool);
 	message_manager_shutdown();
-	s_info.message_factory = NULL;
+	s_info.message_pool = NULL;
 }
 
 static void _set_state(controller_connection_state_e state)
@@ -196,32 +364,73 @@ static void _set_state(controller_connection_state_e state)
 	}
 }
 
-static void _receive_cb(message_t *message, void *data)
+static void _receive_cb(const message_view_t *message, void *data)
 {
 	controller_connection_manager_handle_message(message);
 }
 
-static int _try_connect(const char *ip, int port)
+static bool _receive_filter_cb(const message_view_t *message, void *data)
 {
+	serial_window_result_e order;
+
+	if(s_info.state != CONTROLLER_CONNECTION_STATE_RESERVED || !endpoint_equal(&s_info.controller, message_view_get_sender(message))) {
+		return true;
+	}
+
+	/* checked on arrival, before COMMAND coalescing reorders handling */
+	order = serial_window_update(&s_info.serials, message_view_get_serial(message));
+	if(order == SERIAL_WINDOW_DUPLICATE || order == SERIAL_WINDOW_STALE) {
+		_drop_repeated(message, order);
+		return false;
+	}
+
+	/* coalesced commands are counted too, so they are not seen as lost */
+	_link_stats_received(message);
+	return true;
+}
+
+static int _try_connect(const endpoint_t *controller, message_wire_version_e peer_version)
+{
+	char address_str[ENDPOINT_STR_LEN];
+
 	if(s_info.state != CONTROLLER_CONNECTION_STATE_READY) {
-		_E("Attempt to connect failed - already reserved by %s:%d", s_info.controller_address, s_info.controller_port);
+		_E("Attempt to connect failed - already reserved by %s", endpoint_to_string(&s_info.controller, address_str, sizeof(address_str)));
 		return -1;
 	}
-
-	s_info.controller_address = strdup(ip);
-	if(!s_info.controller_address) {
-		_E("Failed to save controller address");
+	if(connection_table_add(&s_info.sessions, controller, MESSAGE_ROLE_DRIVER) < 0) {
+		_E("Attempt to connect failed - no free session for %s", endpoint_to_string(controller, address_str, sizeof(address_str)));
 		return -1;
 	}
 
-	s_info.controller_port = port;
+	s_info.controller = *controller;
+	s_info.wire_version = peer_version > MESSAGE_WIRE_VERSION_MAX ? MESSAGE_WIRE_VERSION_MAX :
+			peer_version < MESSAGE_WIRE_V1 ? MESSAGE_WIRE_V1 : peer_version;
+	message_manager_set_peer_version(&s_info.controller, s_info.wire_version);
+
+	/* resent by the timer until KEEP_ALIVE arrives, only serial changes */
+	message_connect_accepted_t *accepted = message_pool_get_connect_accepted(s_info.message_pool);
+	accepted->version = s_info.wire_version;
+	if(message_prebuilt_init(&s_info.connect_accepted, &accepted->base)) {
+		_E("Failed to build CONNECT_ACCEPTED message");
+	}
+
 	_set_state(CONTROLLER_CONNECTION_STATE_RESERVED);
 	if(!_send_connect_accept()) {
 		_E("Failed to send CONNECT_ACCEPT");
 	}
 	_reset_counters();
-	s_info.connect_accept_timer = g_timeout_add(HELLO_ACCEPT_INTERVAL, _connect_accept_timer_cb, NULL);
-	s_info.keep_alive_check_timer = g_timeout_add(KEEP_ALIVE_CHECK_INTERVAL, _keep_alive_check_timer_cb, NULL);
+	serial_window_init(&s_info.serials);
+	link_stats_init(&s_info.link_stats);
+	s_info.link_stats_serial = -1;
+	_mark_alive();
+	timer_wheel_schedule(&s_info.timers, &s_info.connect_accept_timer,
+			s_info.last_alive_ns + HELLO_ACCEPT_INTERVAL * CLOCK_NS_PER_MS);
+	timer_wheel_schedule(&s_info.timers, &s_info.keep_alive_timer,
+			s_info.last_alive_ns + s_info.keep_alive_timeout_ns);
+	if(s_info.link_stats_interval_ns) {
+		timer_wheel_schedule(&s_info.timers, &s_info.link_stats_timer,
+				s_info.last_alive_ns + s_info.link_stats_interval_ns);
+	}
 	return 0;
 }
 
@@ -232,12 +441,23 @@ static void _disconnect()
 		return;
 	}
 
-	SAFE_SOURCE_REMOVE(s_info.connect_accept_timer);
+	timer_wheel_cancel(&s_info.timers, &s_info.connect_accept_timer);
+	timer_wheel_cancel(&s_info.timers, &s_info.keep_alive_timer);
+	timer_wheel_cancel(&s_info.timers, &s_info.link_stats_timer);
 
-	SAFE_SOURCE_REMOVE(s_info.keep_alive_check_timer);
+	link_stats_summary_s stats;
+	link_stats_get_summary(&s_info.link_stats, &stats);
+	_I("Link stats: rtt %d us (var %d us), jitter %d us, received %llu, lost %llu (%u ppm), reordered %llu",
+			_to_us(stats.rtt_ns), _to_us(stats.rtt_var_ns), _to_us(stats.jitter_ns),
+			(unsigned long long)stats.received, (unsigned long long)stats.lost, stats.loss_ppm,
+			(unsigned long long)stats.reordered);
+	const serial_window_stats_s *serials = serial_window_get_stats(&s_info.serials);
+	_I("Serials: %llu new, %llu late, %llu duplicate, %llu stale", serials->new, serials->late, serials->duplicate, serials->stale);
 
-	free(s_info.controller_address);
-	s_info.controller_port = 0;
+	message_manager_set_peer_version(&s_info.controller, MESSAGE_WIRE_V1);
+	s_info.wire_version = MESSAGE_WIRE_V1;
+	connection_table_remove(&s_info.sessions, connection_table_find(&s_info.sessions, &s_info.controller));
+	memset(&s_info.controller, 0x0, sizeof(endpoint_t));
 	_set_state(CONTROLLER_CONNECTION_STATE_READY);
 }
 
@@ -252,44 +472,260 @@ static gboolean _send_connect_accept()
 		_disconnect();
 		return FALSE;
 	}
-	message_t *message = message_factory_create_message(s_info.message_factory, MESSAGE_CONNECT_ACCEPTED);
-	message_set_receiver(message, s_info.controller_address, s_info. controller_port);
-	message_manager_send_message(message);
-	message_destroy(message);
+	message_manager_send_prebuilt(&s_info.connect_accepted, &s_info.controller);
 	return TRUE;
 }
 
-static gboolean _connect_accept_timer_cb(gpointer data)
+static void _send_ack(const endpoint_t *receiver, int64_t serial)
+{
+	message_ack_t *response = message_pool_get_ack(s_info.message_pool);
+	message_ack_set_ack_serial(response, serial);
+	message_set_receiver((message_t*)response, receiver);
+	message_manager_send_message((message_t*)response);
+}
+
+static void _mark_alive()
+{
+	/* keep alive timer is not moved here, it checks this time when it expires */
+	s_info.last_alive_ns = clock_monotonic_ns_get();
+}
+
+static void _connect_accept_timer_cb(timer_wheel_timer_t *timer, void *data)
 {
-	return _send_connect_accept();
+	if(_send_connect_accept()) {
+		timer_wheel_schedule(&s_info.timers, timer, clock_monotonic_ns_get() + HELLO_ACCEPT_INTERVAL * CLOCK_NS_PER_MS);
+	}
 }
 
-static gboolean _keep_alive_check_timer_cb(gpointer data)
+static void _keep_alive_timer_cb(timer_wheel_timer_t *timer, void *data)
 {
+	int64_t deadline = s_info.last_alive_ns + s_info.keep_alive_timeout_ns;
+
 	if(s_info.state != CONTROLLER_CONNECTION_STATE_RESERVED) {
 		_E("Incorrect state of connection");
+		return;
 	}
 
-	if(!s_info.keep_alive_check_attempts_left--) {
-		_W("KEEP ALIVE timeout reached - disconnecting started");
-		_disconnect();
-		return FALSE;
+	if(clock_monotonic_ns_get() < deadline) {
+		timer_wheel_schedule(&s_info.timers, timer, deadline);
+		return;
+	}
+
+	_W("KEEP ALIVE timeout reached - disconnecting started");
+	_disconnect();
+}
+
+static void _link_stats_received(const message_view_t *message)
+{
+	link_stats_received(&s_info.link_stats, message_view_get_serial(message));
+	if(message_view_get_type(message) == MESSAGE_COMMAND) {
+		link_stats_command_arrived(&s_info.link_stats, message_view_get_timestamp(message), clock_monotonic_ns_get());
 	}
-	return TRUE;
+}
+
+static void _drop_repeated(const message_view_t *message, serial_window_result_e order)
+{
+	int64_t serial = message_view_get_serial(message);
+
+	_D("Dropped %s message %d (%lld)", order == SERIAL_WINDOW_DUPLICATE ? "duplicated" : "stale",
+			message_view_get_type(message), (long long)serial);
+
+	/* our ACK could be lost, so retransmitted requests are confirmed again */
+	if(message_view_get_type(message) == MESSAGE_BATCH ||
+			(message_view_get_type(message) == MESSAGE_KEEP_ALIVE && !message->in_batch)) {
+		_send_ack(&s_info.controller, serial);
+	}
+}
+
+static int32_t _to_us(int64_t ns)
+{
+	if(ns < 0) {
+		return -1;
+	}
+	return ns / 1000 > INT32_MAX ? INT32_MAX : ns / 1000;
+}
+
+static void _link_stats_timer_cb(timer_wheel_timer_t *timer, void *data)
+{
+	int64_t now = clock_monotonic_ns_get();
+	link_stats_summary_s stats;
+
+	if(s_info.state != CONTROLLER_CONNECTION_STATE_RESERVED) {
+		_E("Incorrect state of connection");
+		return;
+	}
+	timer_wheel_schedule(&s_info.timers, timer, now + s_info.link_stats_interval_ns);
+
+	/* controller does not listen before it confirms CONNECT_ACCEPTED */
+	if(timer_wheel_timer_is_scheduled(&s_info.connect_accept_timer)) {
+		return;
+	}
+
+	link_stats_get_summary(&s_info.link_stats, &stats);
+	message_link_stats_t *message = message_pool_get_link_stats(s_info.message_pool);
+	message->rtt = _to_us(stats.rtt_ns);
+	message->rtt_var = _to_us(stats.rtt_var_ns);
+	message->jitter = _to_us(stats.jitter_ns);
+	message->received = stats.received;
+	message->lost = stats.lost;
+	message->reordered = stats.reordered;
+	message_set_receiver(&message->base, &s_info.controller);
+	if(message_manager_send_message(&message->base)) {
+		_W("Failed to send LINK_STATS message");
+		return;
+	}
+
+	s_info.link_stats_serial = message_get_serial(&message->base);
+	s_info.link_stats_sent_ns = now;
+
+	if(s_info.observer_count && message_manager_send_message_to_all(&message->base, s_info.observer_endpoints, s_info.observer_count)) {
+		_W("Failed to send LINK_STATS message to observers");
+	}
+}
+
+static void _try_observe(const endpoint_t *observer)
+{
+	char address_str[ENDPOINT_STR_LEN];
+	int session = -1;
+
+	if(s_info.observer_count < MAX_OBSERVERS) {
+		session = connection_table_add(&s_info.sessions, observer, MESSAGE_ROLE_OBSERVER);
+	}
+	if(session < 0) {
+		_W("Refused observer %s (%u observers)", endpoint_to_string(observer, address_str, sizeof(address_str)), s_info.observer_count);
+		message_manager_send_prebuilt(&s_info.connect_refused, observer);
+		return;
+	}
+
+	s_info.observers[session].last_alive_ns = clock_monotonic_ns_get();
+	timer_wheel_schedule(&s_info.timers, &s_info.observers[session].keep_alive_timer,
+			s_info.observers[session].last_alive_ns + s_info.keep_alive_timeout_ns);
+	_update_observer_endpoints();
+	message_manager_send_prebuilt(&s_info.observer_accepted, observer);
+	_I("Observer %s connected", endpoint_to_string(observer, address_str, sizeof(address_str)));
+}
+
+static void _handle_observer_message(int session, const message_view_t *message)
+{
+	const endpoint_t *observer = message_view_get_sender(message);
+	char address_str[ENDPOINT_STR_LEN];
+
+	s_info.observers[session].last_alive_ns = clock_monotonic_ns_get();
+
+	switch(message_view_get_type(message)) {
+	case MESSAGE_CONNECT:
+		/* previous CONNECT_ACCEPTED could be lost */
+		message_manager_send_prebuilt(&s_info.observer_accepted, observer);
+		break;
+	case MESSAGE_KEEP_ALIVE:
+		if(!message->in_batch) {
+			_send_ack(observer, message_view_get_serial(message));
+		}
+		break;
+	case MESSAGE_BATCH:
+		_send_ack(observer, message_view_get_serial(message));
+		break;
+	case MESSAGE_BYE:
+		_remove_observer(session);
+		break;
+	case MESSAGE_COMMAND:
+		_W_RL(1, "Ignored COMMAND of observer %s", endpoint_to_string(observer, address_str, sizeof(address_str)));
+		break;
+	default:
+		break;
+	}
+}
+
+static void _remove_observer(int session)
+{
+	char address_str[ENDPOINT_STR_LEN];
+	const connection_table_entry_s *entry = connection_table_get(&s_info.sessions, session);
+
+	if(!entry->used || entry->role != MESSAGE_ROLE_OBSERVER) {
+		return;
+	}
+
+	_I("Observer %s disconnected", endpoint_to_string(&entry->endpoint, address_str, sizeof(address_str)));
+	timer_wheel_cancel(&s_info.timers, &s_info.observers[session].keep_alive_timer);
+	connection_table_remove(&s_info.sessions, session);
+	_update_observer_endpoints();
+}
+
+static void _update_observer_endpoints()
+{
+	const connection_table_entry_s *entry;
+
+	s_info.observer_count = 0;
+	for(int i = 0; i < CONNECTION_TABLE_CAPACITY; i++) {
+		entry = connection_table_get(&s_info.sessions, i);
+		if(entry->used && entry->role == MESSAGE_ROLE_OBSERVER) {
+			s_info.observer_endpoints[s_info.observer_count++] = entry->endpoint;
+		}
+	}
+}
+
+static void _observer_timer_cb(timer_wheel_timer_t *timer, void *data)
+{
+	_observer_s *observer = data;
+	int64_t deadline = observer->last_alive_ns + s_info.keep_alive_timeout_ns;
+
+	if(clock_monotonic_ns_get() < deadline) {
+		timer_wheel_schedule(&s_info.timers, timer, deadline);
+		return;
+	}
+
+	_W("Observer KEEP ALIVE timeout reached");
+	_remove_observer(observer - s_info.observers);
 }
 
 static void _reset_counters()
 {
-	s_info.keep_alive_check_attempts_left = KEEP_ALIVE_CHECK_ATTEMPTS;
 	s_info.connect_accept_attempts_left = HELLO_ACCEPT_ATTEMPTS;
 }
 
-static int _addr_cmp(const char *addr1, int port1, const char *addr2, int port2)
+static gboolean _timer_source_prepare(GSource *source, gint *timeout)
 {
-	if(addr1 == NULL || addr2 == NULL) {
-		return -1;
+	int64_t deadline = timer_wheel_next_deadline(((_timer_source_s*)source)->wheel);
+	int64_t now;
+
+	if(deadline < 0) {
+		*timeout = -1;
+		return FALSE;
+	}
+
+	now = clock_monotonic_ns_get();
+	if(deadline <= now) {
+		*timeout = 0;
+		return TRUE;
 	}
 
-	unsigned int address_length = strlen(addr2);
-	return port1 != port2 || strlen(addr1) != address_length || strncmp(addr1, addr2, address_length);
+	*timeout = (deadline - now + CLOCK_NS_PER_MS - 1) / CLOCK_NS_PER_MS;
+	return FALSE;
+}
+
+static gboolean _timer_source_check(GSource *source)
+{
+	int64_t deadline = timer_wheel_next_deadline(((_timer_source_s*)source)->wheel);
+
+	return deadline >= 0 && deadline <= clock_monotonic_ns_get();
+}
+
+static gboolean _timer_source_dispatch(GSource *source, GSourceFunc callback, gpointer data)
+{
+	timer_wheel_advance(((_timer_source_s*)source)->wheel, clock_monotonic_ns_get());
+	return TRUE;
+}
+
+static GSourceFuncs _timer_source_funcs = {
+	.prepare = _timer_source_prepare,
+	.check = _timer_source_check,
+	.dispatch = _timer_source_dispatch,
+};
+
+static GSource *_timer_source_new(timer_wheel_t *wheel)
+{
+	GSource *source = g_source_new(&_timer_source_funcs, sizeof(_timer_source_s));
+	((_timer_source_s*)source)->wheel = wheel;
+	g_source_attach(source, g_main_context_get_thread_default());
+	return source;
 }
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "endpoint.h"
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+void endpoint_from_sockaddr(endpoint_t *endpoint, const struct sockaddr_in *addr)
+{
+	endpoint->address = addr->sin_addr.s_addr;
+	endpoint->port = ntohs(addr->sin_port);
+}
+
+void endpoint_to_sockaddr(const endpoint_t *endpoint, struct sockaddr_in *addr)
+{
+	memset(addr, 0x0, sizeof(struct sockaddr_in));
+	addr->sin_family = AF_INET;
+	addr->sin_addr.s_addr = endpoint->address;
+	addr->sin_port = htons(endpoint->port);
+}
+
+int endpoint_from_string(endpoint_t *endpoint, const char *ip, int port)
+{
+	struct in_addr addr;
+
+	if (!ip || port < 0 || port > UINT16_MAX)
+		return -1;
+
+	if (inet_pton(AF_INET, ip, &addr) != 1)
+		return -1;
+
+	endpoint->address = addr.s_addr;
+	endpoint->port = port;
+	return 0;
+}
+
+const char *endpoint_to_string(const endpoint_t *endpoint, char *buf, size_t len)
+{
+	char ip[INET_ADDRSTRLEN];
+	struct in_addr addr = { .s_addr = endpoint->address };
+
+	if (!inet_ntop(AF_INET, &addr, ip, sizeof(ip)))
+		snprintf(ip, sizeof(ip), "?");
+
+	snprintf(buf, len, "%s:%u", ip, endpoint->port);
+	return buf;
+}
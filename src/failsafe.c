@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "failsafe.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "messages/clock.h"
+
+#define FAILSAFE_TIMEOUT 250 //In ms
+#define FAILSAFE_MAX_TIMEOUT 1000 //In ms
+#define FAILSAFE_INTERVAL_FACTOR 4
+#define FAILSAFE_DECELERATION 2000 //Full speed stops in 0.5 s
+#define FAILSAFE_BRAKE_SPEED 50
+#define FAILSAFE_STEP 20 //In ms
+#define INTERVAL_AVERAGE_SHIFT 3
+
+void failsafe_config_default(failsafe_config_s *config)
+{
+	config->timeout_ns = FAILSAFE_TIMEOUT * CLOCK_NS_PER_MS;
+	config->max_timeout_ns = FAILSAFE_MAX_TIMEOUT * CLOCK_NS_PER_MS;
+	config->interval_factor = FAILSAFE_INTERVAL_FACTOR;
+	config->deceleration = FAILSAFE_DECELERATION;
+	config->brake_speed = FAILSAFE_BRAKE_SPEED;
+	config->step_ns = FAILSAFE_STEP * CLOCK_NS_PER_MS;
+}
+
+void failsafe_init(failsafe_t *failsafe, const failsafe_config_s *config)
+{
+	memset(failsafe, 0x0, sizeof(*failsafe));
+	failsafe->config = *config;
+	failsafe->state = FAILSAFE_STATE_IDLE;
+}
+
+static bool _drive_values(const command_s *command, int *speed, int *direction)
+{
+	switch (command->type) {
+	case COMMAND_TYPE_DRIVE:
+		*speed = command->data.steering.speed;
+		*direction = command->data.steering.direction;
+		return true;
+	case COMMAND_TYPE_DRIVE_AND_CAMERA:
+		*speed = command->data.steering_and_camera.speed;
+		*direction = command->data.steering_and_camera.direction;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void failsafe_command(failsafe_t *failsafe, const command_s *command, int64_t now_ns)
+{
+	int64_t interval = now_ns - failsafe->last_command_ns;
+
+	/* average only intervals of a stream, not gaps between separate drives */
+	if (failsafe->state == FAILSAFE_STATE_ARMED && interval < failsafe->config.max_timeout_ns) {
+		if (failsafe->interval_ns)
+			failsafe->interval_ns += (interval - failsafe->interval_ns) >> INTERVAL_AVERAGE_SHIFT;
+		else
+			failsafe->interval_ns = interval;
+	}
+	failsafe->last_command_ns = now_ns;
+
+	if (_drive_values(command, &failsafe->speed, &failsafe->direction)) {
+		failsafe->state = failsafe->speed ? FAILSAFE_STATE_ARMED : FAILSAFE_STATE_IDLE;
+	} else if (failsafe->state != FAILSAFE_STATE_IDLE) {
+		failsafe->state = FAILSAFE_STATE_ARMED;
+	}
+}
+
+void failsafe_trip(failsafe_t *failsafe, int64_t now_ns)
+{
+	if (failsafe->state != FAILSAFE_STATE_ARMED)
+		return;
+
+	failsafe->state = FAILSAFE_STATE_DECAYING;
+	failsafe->last_step_ns = now_ns;
+}
+
+int64_t failsafe_get_timeout(const failsafe_t *failsafe)
+{
+	int64_t timeout = failsafe->interval_ns * failsafe->config.interval_factor;
+
+	if (timeout < failsafe->config.timeout_ns)
+		return failsafe->config.timeout_ns;
+	if (timeout > failsafe->config.max_timeout_ns)
+		return failsafe->config.max_timeout_ns;
+	return timeout;
+}
+
+failsafe_action_e failsafe_poll(failsafe_t *failsafe, int64_t now_ns, int *speed, int *direction)
+{
+	int64_t decrease;
+	int magnitude;
+
+	switch (failsafe->state) {
+	case FAILSAFE_STATE_ARMED:
+		if (now_ns - failsafe->last_command_ns < failsafe_get_timeout(failsafe))
+			return FAILSAFE_ACTION_NONE;
+		failsafe_trip(failsafe, now_ns);
+		/* first step is taken at once */
+		decrease = failsafe->config.deceleration * failsafe->config.step_ns / CLOCK_NS_PER_SEC;
+		break;
+	case FAILSAFE_STATE_DECAYING:
+		decrease = failsafe->config.deceleration * (now_ns - failsafe->last_step_ns) / CLOCK_NS_PER_SEC;
+		if (decrease <= 0)
+			return FAILSAFE_ACTION_NONE;
+		failsafe->last_step_ns = now_ns;
+		break;
+	default:
+		return FAILSAFE_ACTION_NONE;
+	}
+
+	magnitude = abs(failsafe->speed) - decrease;
+	if (magnitude <= failsafe->config.brake_speed) {
+		failsafe->speed = 0;
+		failsafe->state = FAILSAFE_STATE_STOPPED;
+		return FAILSAFE_ACTION_BRAKE;
+	}
+
+	failsafe->speed = failsafe->speed > 0 ? magnitude : -magnitude;
+	*speed = failsafe->speed;
+	*direction = failsafe->direction;
+	return FAILSAFE_ACTION_DECAY;
+}
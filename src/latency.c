@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "latency.h"
+#include <string.h>
+#include <stdbool.h>
+#include "log.h"
+#include "messages/clock.h"
+
+/*
+ * Log-linear histogram, as in HdrHistogram: values below SUB_BUCKET_COUNT
+ * have own buckets, above that every power of two is split into
+ * SUB_BUCKET_HALF buckets, so relative error stays below 1/16.
+ */
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+#define SUB_BUCKET_HALF (SUB_BUCKET_COUNT / 2)
+#define MAX_EXPONENT 40 /* ~18 minutes, bigger values go to the last bucket */
+#define BUCKET_COUNT (SUB_BUCKET_COUNT + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF)
+
+typedef struct _latency_histogram {
+	unsigned long long buckets[BUCKET_COUNT];
+	unsigned long long sum;
+	int64_t max;
+} _latency_histogram_s;
+
+static _latency_histogram_s s_histograms[LATENCY_STAGE_MAX];
+
+static __thread latency_trace_s t_trace;
+
+static const char *s_stage_names[LATENCY_STAGE_MAX] = {
+	[LATENCY_STAGE_DESERIALIZE] = "deserialize",
+	[LATENCY_STAGE_DISPATCH] = "dispatch",
+	[LATENCY_STAGE_MAPPING] = "mapping",
+	[LATENCY_STAGE_ACTUATE] = "actuate",
+	[LATENCY_STAGE_END_TO_END] = "end-to-end",
+};
+
+static unsigned int _bucket_index(uint64_t value)
+{
+	unsigned int exponent;
+
+	if (value < SUB_BUCKET_COUNT)
+		return value;
+
+	exponent = 63 - __builtin_clzll(value);
+	if (exponent > MAX_EXPONENT)
+		return BUCKET_COUNT - 1;
+
+	return SUB_BUCKET_COUNT
+		+ (exponent - SUB_BUCKET_BITS) * SUB_BUCKET_HALF
+		+ (value >> (exponent - SUB_BUCKET_BITS + 1)) - SUB_BUCKET_HALF;
+}
+
+/* highest value falling into bucket */
+static int64_t _bucket_value(unsigned int index)
+{
+	unsigned int exponent;
+	unsigned int shift;
+	uint64_t mantissa;
+
+	if (index < SUB_BUCKET_COUNT)
+		return index;
+
+	exponent = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF + SUB_BUCKET_BITS;
+	mantissa = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+	shift = exponent - SUB_BUCKET_BITS + 1;
+
+	return ((mantissa + 1) << shift) - 1;
+}
+
+static void _histogram_record(_latency_histogram_s *histogram, int64_t value)
+{
+	int64_t max;
+
+	if (value < 0)
+		value = 0;
+
+	__atomic_fetch_add(&histogram->buckets[_bucket_index(value)], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+
+	max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+	while (value > max &&
+		!__atomic_compare_exchange_n(&histogram->max, &max, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+void latency_trace_begin(void)
+{
+	latency_trace_begin_at(clock_monotonic_ns_get());
+}
+
+void latency_trace_begin_at(int64_t received_ns)
+{
+	memset(&t_trace, 0, sizeof(t_trace));
+	t_trace.points[LATENCY_POINT_RECEIVED] = received_ns;
+}
+
+void latency_trace_mark(latency_point_e point)
+{
+	if (!t_trace.points[LATENCY_POINT_RECEIVED])
+		return;
+
+	t_trace.points[point] = clock_monotonic_ns_get();
+}
+
+void latency_trace_end(void)
+{
+	int64_t previous = t_trace.points[LATENCY_POINT_RECEIVED];
+	int point;
+
+	if (!previous)
+		return;
+
+	for (point = LATENCY_POINT_RECEIVED + 1; point < LATENCY_POINT_MAX; point++) {
+		if (!t_trace.points[point])
+			continue;
+		_histogram_record(&s_histograms[point], t_trace.points[point] - previous);
+		previous = t_trace.points[point];
+	}
+
+	if (t_trace.points[LATENCY_POINT_ACTUATED])
+		_histogram_record(&s_histograms[LATENCY_STAGE_END_TO_END],
+			t_trace.points[LATENCY_POINT_ACTUATED] - t_trace.points[LATENCY_POINT_RECEIVED]);
+
+	memset(&t_trace, 0, sizeof(t_trace));
+}
+
+void latency_trace_save(latency_trace_s *trace)
+{
+	*trace = t_trace;
+}
+
+void latency_trace_restore(const latency_trace_s *trace)
+{
+	t_trace = *trace;
+}
+
+static int64_t _percentile(const unsigned long long *buckets, unsigned long long count, int64_t max, double quantile)
+{
+	unsigned long long target = quantile * count;
+	unsigned long long seen = 0;
+	unsigned int i;
+	int64_t value;
+
+	if (target < quantile * count || target == 0)
+		target++;
+
+	for (i = 0; i < BUCKET_COUNT; i++) {
+		seen += buckets[i];
+		if (seen >= target) {
+			value = _bucket_value(i);
+			return value < max ? value : max;
+		}
+	}
+
+	return max;
+}
+
+void latency_get_summary(latency_stage_e stage, latency_summary_s *summary)
+{
+	_latency_histogram_s *histogram = &s_histograms[stage];
+	unsigned long long buckets[BUCKET_COUNT];
+	unsigned long long count = 0;
+	unsigned int i;
+
+	memset(summary, 0, sizeof(*summary));
+
+	/* counters keep changing while we read, so percentiles use own total */
+	for (i = 0; i < BUCKET_COUNT; i++) {
+		buckets[i] = __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+		count += buckets[i];
+	}
+
+	if (!count)
+		return;
+
+	summary->count = count;
+	summary->max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+	summary->mean = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED) / count;
+	summary->p50 = _percentile(buckets, count, summary->max, 0.5);
+	summary->p99 = _percentile(buckets, count, summary->max, 0.99);
+	summary->p999 = _percentile(buckets, count, summary->max, 0.999);
+}
+
+const char *latency_stage_name(latency_stage_e stage)
+{
+	if (stage >= LATENCY_STAGE_MAX || !s_stage_names[stage])
+		return "unknown";
+
+	return s_stage_names[stage];
+}
+
+void latency_dump(void)
+{
+	latency_summary_s summary;
+	int stage;
+
+	for (stage = LATENCY_STAGE_DESERIALIZE; stage < LATENCY_STAGE_MAX; stage++) {
+		latency_get_summary(stage, &summary);
+		_I("latency %-11s n=%llu mean=%.1fus p50=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus",
+			latency_stage_name(stage), summary.count, summary.mean / 1000.0,
+			summary.p50 / 1000.0, summary.p99 / 1000.0, summary.p999 / 1000.0,
+			summary.max / 1000.0);
+	}
+}
+
+void latency_reset(void)
+{
+	int stage;
+	unsigned int i;
+
+	for (stage = 0; stage < LATENCY_STAGE_MAX; stage++) {
+		for (i = 0; i < BUCKET_COUNT; i++)
+			__atomic_store_n(&s_histograms[stage].buckets[i], 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&s_histograms[stage].sum, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&s_histograms[stage].max, 0, __ATOMIC_RELAXED);
+	}
+}
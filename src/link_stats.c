@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "link_stats.h"
+
+#include <string.h>
+#include "messages/clock.h"
+
+#define MAX_DROPOUT 3000 //Bigger forward jump of serial starts new sequence
+#define MAX_MISORDER 100 //Older messages are not counted at all
+#define RTT_SHIFT 3 //Gain 1/8
+#define RTT_VAR_SHIFT 2 //Gain 1/4
+#define JITTER_SHIFT 4 //Gain 1/16
+
+void link_stats_init(link_stats_t *stats)
+{
+	memset(stats, 0x0, sizeof(*stats));
+}
+
+static inline uint64_t _expected(const link_stats_t *stats)
+{
+	return stats->synced ? stats->max_serial - stats->base_serial + 1 : 0;
+}
+
+static void _resync(link_stats_t *stats, int64_t serial)
+{
+	uint64_t expected = _expected(stats);
+
+	if (expected > stats->received)
+		stats->base_lost += expected - stats->received;
+	stats->base_expected += expected;
+	stats->base_received += stats->received;
+	stats->base_serial = serial;
+	stats->max_serial = serial;
+	stats->received = 1;
+	stats->synced = true;
+}
+
+bool link_stats_received(link_stats_t *stats, int64_t serial)
+{
+	int64_t delta;
+
+	if (!stats->synced) {
+		_resync(stats, serial);
+		return true;
+	}
+
+	delta = serial - stats->max_serial;
+	if (delta > MAX_DROPOUT) {
+		_resync(stats, serial);
+		return true;
+	}
+	if (delta > 0) {
+		stats->max_serial = serial;
+		stats->received++;
+		return true;
+	}
+	/* duplicates cannot be told from late messages, so both are counted */
+	if (delta < 0 && delta >= -MAX_MISORDER && serial >= stats->base_serial) {
+		stats->received++;
+		stats->reordered++;
+	}
+	return false;
+}
+
+void link_stats_command_arrived(link_stats_t *stats, int64_t timestamp, int64_t now_ns)
+{
+	int64_t d;
+
+	if (stats->has_arrival) {
+		d = (now_ns - stats->last_arrival_ns) - (timestamp - stats->last_timestamp) * CLOCK_NS_PER_MS;
+		if (d < 0)
+			d = -d;
+		stats->jitter_ns += (d - stats->jitter_ns) >> JITTER_SHIFT;
+	}
+
+	stats->has_arrival = true;
+	stats->last_arrival_ns = now_ns;
+	stats->last_timestamp = timestamp;
+}
+
+void link_stats_rtt_sample(link_stats_t *stats, int64_t rtt_ns)
+{
+	int64_t err;
+
+	if (rtt_ns < 0)
+		return;
+
+	if (!stats->has_rtt) {
+		stats->rtt_ns = rtt_ns;
+		stats->rtt_var_ns = rtt_ns / 2;
+		stats->has_rtt = true;
+		return;
+	}
+
+	err = stats->rtt_ns - rtt_ns;
+	if (err < 0)
+		err = -err;
+	stats->rtt_var_ns += (err - stats->rtt_var_ns) >> RTT_VAR_SHIFT;
+	stats->rtt_ns += (rtt_ns - stats->rtt_ns) >> RTT_SHIFT;
+}
+
+void link_stats_get_summary(const link_stats_t *stats, link_stats_summary_s *summary)
+{
+	uint64_t expected = _expected(stats);
+	uint64_t lost = stats->base_lost;
+
+	if (expected > stats->received)
+		lost += expected - stats->received;
+	expected += stats->base_expected;
+
+	summary->rtt_ns = stats->has_rtt ? stats->rtt_ns : -1;
+	summary->rtt_var_ns = stats->has_rtt ? stats->rtt_var_ns : -1;
+	summary->jitter_ns = stats->jitter_ns;
+	summary->received = stats->base_received + stats->received;
+	summary->lost = lost;
+	summary->reordered = stats->reordered;
+	summary->loss_ppm = expected ? (unsigned int)(lost * 1000000 / expected) : 0;
+}
@@ -5,15 +5,68 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <app_common.h>
 #include "log.h"
+#include "log_binary.h"
+#include "messages/clock.h"
 
 #define MAX_LOG_SIZE 4096
 #define PATH_MAX 4096
+#define ASYNC_RECORD_TEXT_SIZE 256
+#define ASYNC_DEFAULT_CAPACITY 1024
+#define ASYNC_FLUSH_INTERVAL_US 10000
+#define BINARY_LOG_FILE "log.bin"
+#define BINARY_LOG_FILE_OLD "log.bin.1"
+#define LOG_SITE_PENDING UINT32_MAX
+
+/*
+ * Async mode: bounded MPSC ring of preformatted records (per-slot sequence
+ * numbers, see D. Vyukov's bounded queue). Producers never wait, a full
+ * ring drops the record. Single writer thread drains it in batches.
+ */
+typedef struct _log_record {
+	size_t sequence;
+	log_priority prio;
+	const char *tag;
+	struct timeval time;
+	char text[ASYNC_RECORD_TEXT_SIZE];
+} log_record_s;
+
+static struct {
+	log_record_s *records;
+	size_t mask;
+	size_t enqueue_pos __attribute__((aligned(64)));
+	size_t dequeue_pos __attribute__((aligned(64)));
+	unsigned long long written;
+	unsigned long long dropped;
+	unsigned long long reported_dropped;
+	int running;
+	int producers;
+	int stopping;
+	pthread_t thread;
+} async;
+
+/* Binary mode: records go to memory mapped file, see log_binary.h */
+static struct {
+	int fd;
+	uint8_t *map;
+	log_binary_header_s *header;
+	uint8_t *sites;
+	log_binary_slot_s *slots;
+	log_site_s *registered; /* sites with ids, reset when a new file is opened */
+	unsigned long long dropped;
+} binary = { .fd = -1 };
 
 static FILE *log_fp = NULL;
 static log_type ltype = LOG_TYPE_DLOG;
 
+log_priority log_level = DLOG_DEBUG;
+
 static const char log_prio_name[][DLOG_PRIO_MAX-1] = {
 	"UNKNOWN",
 	"DEFAULT", /**< Default */
@@ -26,20 +79,26 @@ static const char log_prio_name[][DLOG_PRIO_MAX-1] = {
 	"SILENT" /**< Silent */
 };
 
+static inline void __format_time(const struct timeval *val, char *res_time, size_t len)
+{
+	struct tm tm;
+
+	localtime_r(&val->tv_sec, &tm);
+
+	// format : YYMMDDhhmmssuuuuuu
+	snprintf(res_time, len, "%04d-%02d-%02d %02d:%02d:%02d:%06ld"
+		, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday
+		, tm.tm_hour, tm.tm_min, tm.tm_sec
+		, (long)val->tv_usec);
+}
+
 static inline char* getFormattedTime(void)
 {
 	struct timeval val;
-	struct tm *ptm;
-	static char res_time[40] = {0, };
+	static char res_time[64] = {0, };
 
 	gettimeofday(&val, NULL);
-	ptm = localtime(&val.tv_sec);
-
-	// format : YYMMDDhhmmssuuuuuu
-	snprintf(res_time, sizeof(res_time), "%04d-%02d-%02d %02d:%02d:%02d:%06ld"
-		, ptm->tm_year + 1900, ptm->tm_mon + 1, ptm->tm_mday
-		, ptm->tm_hour, ptm->tm_min, ptm->tm_sec
-		, val.tv_usec);
+	__format_time(&val, res_time, sizeof(res_time));
 
 	return res_time;
 }
@@ -71,6 +130,169 @@ error:
 	return -1;
 }
 
+static int __data_file_path(char *buf, size_t len, const char *name)
+{
+	char *prefix = app_get_data_path();
+
+	if (!prefix)
+		return -1;
+
+	snprintf(buf, len, "%s%s", prefix, name);
+	free(prefix);
+
+	return 0;
+}
+
+static void __close_binary_log(void)
+{
+	if (!binary.map)
+		return;
+
+	binary.header = NULL;
+	msync(binary.map, LOG_BINARY_FILE_SIZE, MS_ASYNC);
+	munmap(binary.map, LOG_BINARY_FILE_SIZE);
+	close(binary.fd);
+	binary.map = NULL;
+	binary.fd = -1;
+
+	if (binary.dropped)
+		dlog_print(DLOG_WARN, LOG_TAG, "binary log - %llu records dropped\n", binary.dropped);
+}
+
+static int __open_binary_log(void)
+{
+	char path[PATH_MAX] = {0,};
+	char old_path[PATH_MAX] = {0,};
+	log_binary_header_s *header;
+	log_site_s *site;
+
+	if (binary.map)
+		return 0;
+
+	if (__data_file_path(path, sizeof(path), BINARY_LOG_FILE)
+			|| __data_file_path(old_path, sizeof(old_path), BINARY_LOG_FILE_OLD))
+		goto error;
+
+	/* keep previous run, e.g. one that crashed */
+	rename(path, old_path);
+
+	binary.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (binary.fd < 0)
+		goto error;
+
+	if (ftruncate(binary.fd, LOG_BINARY_FILE_SIZE))
+		goto error;
+
+	binary.map = mmap(NULL, LOG_BINARY_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, binary.fd, 0);
+	if (binary.map == MAP_FAILED) {
+		binary.map = NULL;
+		goto error;
+	}
+
+	for (site = binary.registered; site; site = site->next)
+		__atomic_store_n(&site->id, 0, __ATOMIC_RELAXED);
+	binary.registered = NULL;
+	binary.dropped = 0;
+
+	header = (log_binary_header_s *)binary.map;
+	memcpy(header->magic, LOG_BINARY_MAGIC, sizeof(LOG_BINARY_MAGIC));
+	header->version = LOG_BINARY_VERSION;
+	header->slot_size = LOG_BINARY_SLOT_SIZE;
+	header->slot_count = LOG_BINARY_SLOT_COUNT;
+	header->sites_size = LOG_BINARY_SITES_SIZE;
+	binary.sites = binary.map + sizeof(log_binary_header_s);
+	binary.slots = (log_binary_slot_s *)(binary.sites + LOG_BINARY_SITES_SIZE);
+	__atomic_store_n(&binary.header, header, __ATOMIC_RELEASE);
+
+	return 0;
+
+error:
+	dlog_print(DLOG_WARN, LOG_TAG, "error to use binary log file %s: %s\n", path, strerror(errno));
+	if (binary.fd >= 0)
+		close(binary.fd);
+	binary.fd = -1;
+	return -1;
+}
+
+static uint32_t __binary_register_site(log_site_s *site, log_priority prio, const char *tag,
+	const char *fmt, const char *func, int line)
+{
+	log_binary_header_s *header = binary.header;
+	log_binary_site_s *entry;
+	size_t tag_len = strlen(tag) + 1;
+	size_t func_len = strlen(func) + 1;
+	size_t fmt_len = strlen(fmt) + 1;
+	uint32_t size = (sizeof(log_binary_site_s) + tag_len + func_len + fmt_len + 7) & ~7u;
+	uint32_t expected = 0;
+	uint32_t offset;
+	uint32_t id;
+
+	/* one thread registers, others drop their records meanwhile */
+	if (!__atomic_compare_exchange_n(&site->id, &expected, LOG_SITE_PENDING,
+			false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		return expected;
+
+	offset = __atomic_fetch_add(&header->sites_used, size, __ATOMIC_RELAXED);
+	if (offset + size > LOG_BINARY_SITES_SIZE)
+		return LOG_SITE_PENDING; /* no room, site stays unregistered */
+
+	id = __atomic_add_fetch(&header->site_count, 1, __ATOMIC_RELAXED);
+
+	entry = (log_binary_site_s *)(binary.sites + offset);
+	entry->id = id;
+	entry->prio = prio;
+	entry->line = line;
+	memcpy(entry->strings, tag, tag_len);
+	memcpy(entry->strings + tag_len, func, func_len);
+	memcpy(entry->strings + tag_len + func_len, fmt, fmt_len);
+	__atomic_store_n(&entry->size, size, __ATOMIC_RELEASE);
+
+	site->next = __atomic_load_n(&binary.registered, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&binary.registered, &site->next, site,
+			true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		;
+	__atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+
+	return id;
+}
+
+/* fmt comes from log.h macros: "[%s:%d] " prefix with function and line, then message */
+static void __binary_write(log_site_s *site, log_priority prio, const char *tag, const char *fmt, va_list ap)
+{
+	log_binary_conversion_s conv;
+	log_binary_slot_s *slot;
+	const char *func;
+	int line;
+	size_t pos = 0;
+	uint32_t id;
+	uint64_t seq;
+	int truncated;
+
+	func = va_arg(ap, const char *);
+	line = va_arg(ap, int);
+	if (log_binary_next_conversion(fmt, &pos, &conv) || log_binary_next_conversion(fmt, &pos, &conv))
+		return;
+
+	id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+	if (id == 0)
+		id = __binary_register_site(site, prio, tag, fmt, func, line);
+	if (id == LOG_SITE_PENDING) {
+		__atomic_fetch_add(&binary.dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	seq = __atomic_fetch_add(&binary.header->next_seq, 1, __ATOMIC_RELAXED);
+	slot = &binary.slots[seq % LOG_BINARY_SLOT_COUNT];
+
+	__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->timestamp = clock_realtime_ns_get();
+	slot->site = id;
+	slot->length = log_binary_pack(slot->payload, sizeof(slot->payload), fmt, pos, ap, &truncated);
+	slot->truncated = truncated;
+	__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
 int log_type_set(log_type type)
 {
 	ltype = type;
@@ -80,6 +302,10 @@ int log_type_set(log_type type)
 	case LOG_TYPE_ALL:
 		__open_log_file();
 		break;
+	case LOG_TYPE_BINARY:
+		if (__open_binary_log())
+			ltype = LOG_TYPE_DLOG;
+		break;
 	case LOG_TYPE_DLOG: /* nothing to do */
 	default:
 		ltype = LOG_TYPE_DLOG;
@@ -88,8 +314,42 @@ int log_type_set(log_type type)
 	return 0;
 }
 
+void log_level_set(log_priority prio)
+{
+	log_level = prio;
+}
+
+int log_ratelimit_pass(log_ratelimit_s *ratelimit, unsigned int per_sec, unsigned int *suppressed)
+{
+	struct timespec ts;
+	long long now;
+
+	/* coarse clock is enough for one second windows and cheaper */
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+	now = ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+
+	if (now - ratelimit->window_start >= 1000) {
+		ratelimit->window_start = now;
+		ratelimit->passed = 0;
+	}
+
+	if (ratelimit->passed >= per_sec) {
+		ratelimit->suppressed++;
+		return 0;
+	}
+
+	ratelimit->passed++;
+	*suppressed = ratelimit->suppressed;
+	ratelimit->suppressed = 0;
+
+	return 1;
+}
+
 void log_file_close(void)
 {
+	log_async_stop();
+	__close_binary_log();
+
 	if (log_fp) {
 		fclose(log_fp);
 		log_fp = NULL;
@@ -101,38 +361,246 @@ void log_file_close(void)
 	return;
 }
 
-int log_print(log_priority prio, const char *tag, const char *fmt, ...)
+static int __log_async_push(log_priority prio, const char *tag, const char *fmt, va_list ap)
 {
-	va_list ap;
+	log_record_s *record;
+	size_t pos = __atomic_load_n(&async.enqueue_pos, __ATOMIC_RELAXED);
+	size_t seq;
+	long dif;
+
+	for (;;) {
+		record = &async.records[pos & async.mask];
+		seq = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+		dif = (long)seq - (long)pos;
+		if (dif == 0) {
+			if (__atomic_compare_exchange_n(&async.enqueue_pos, &pos, pos + 1,
+					true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (dif < 0) {
+			/* full, writer is behind */
+			__atomic_fetch_add(&async.dropped, 1, __ATOMIC_RELAXED);
+			return -1;
+		} else {
+			pos = __atomic_load_n(&async.enqueue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	record->prio = prio;
+	record->tag = tag;
+	gettimeofday(&record->time, NULL);
+	vsnprintf(record->text, sizeof(record->text), fmt, ap);
+	__atomic_store_n(&record->sequence, pos + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+static void __log_async_write(const log_record_s *record)
+{
+	char res_time[64];
+
+	switch (ltype) {
+	case LOG_TYPE_FILE:
+	case LOG_TYPE_ALL:
+		if (log_fp) {
+			__format_time(&record->time, res_time, sizeof(res_time));
+			fprintf(log_fp, "[%s] [%s]%s", res_time, log_prio_name[record->prio], record->text);
+		}
+		if (ltype == LOG_TYPE_FILE)
+			break;
+		/* fall through */
+	case LOG_TYPE_DLOG:
+	default:
+		dlog_print(record->prio, record->tag, "%s", record->text);
+		break;
+	}
+}
+
+/* returns number of records written */
+static unsigned int __log_async_drain(void)
+{
+	log_record_s *record;
+	size_t pos = async.dequeue_pos;
+	unsigned int count = 0;
+	unsigned long long dropped;
+
+	for (;;) {
+		record = &async.records[pos & async.mask];
+		if (__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != pos + 1)
+			break;
+
+		__log_async_write(record);
+		__atomic_store_n(&record->sequence, pos + async.mask + 1, __ATOMIC_RELEASE);
+		pos++;
+		count++;
+	}
+	async.dequeue_pos = pos;
+	async.written += count;
+
+	dropped = __atomic_load_n(&async.dropped, __ATOMIC_RELAXED);
+	if (dropped != async.reported_dropped) {
+		dlog_print(DLOG_WARN, LOG_TAG, "%llu log records dropped\n", dropped - async.reported_dropped);
+		async.reported_dropped = dropped;
+	}
+
+	if (count && log_fp)
+		fflush(log_fp);
+
+	return count;
+}
+
+static void *__log_async_thread(void *data)
+{
+	while (!__atomic_load_n(&async.stopping, __ATOMIC_ACQUIRE)) {
+		if (!__log_async_drain())
+			usleep(ASYNC_FLUSH_INTERVAL_US);
+	}
+	__log_async_drain();
+
+	return NULL;
+}
+
+int log_async_start(unsigned int capacity)
+{
+	size_t i;
+
+	if (async.running)
+		return 0;
+
+	if (capacity == 0)
+		capacity = ASYNC_DEFAULT_CAPACITY;
+
+	if (capacity & (capacity - 1)) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "async log capacity %u is not a power of 2\n", capacity);
+		return -1;
+	}
+
+	async.records = malloc(capacity * sizeof(log_record_s));
+	if (!async.records)
+		return -1;
+
+	for (i = 0; i < capacity; i++)
+		async.records[i].sequence = i;
+	async.mask = capacity - 1;
+	async.enqueue_pos = 0;
+	async.dequeue_pos = 0;
+	async.written = 0;
+	async.dropped = 0;
+	async.reported_dropped = 0;
+	async.stopping = 0;
+
+	if (pthread_create(&async.thread, NULL, __log_async_thread, NULL)) {
+		free(async.records);
+		async.records = NULL;
+		return -1;
+	}
+
+	__atomic_store_n(&async.running, 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+void log_async_stop(void)
+{
+	if (!async.running)
+		return;
+
+	/* late producers fall back to synchronous mode, wait for ones already pushing */
+	__atomic_store_n(&async.running, 0, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&async.producers, __ATOMIC_SEQ_CST))
+		sched_yield();
+	__atomic_store_n(&async.stopping, 1, __ATOMIC_RELEASE);
+	pthread_join(async.thread, NULL);
+
+	dlog_print(DLOG_INFO, LOG_TAG, "async log - %llu records written, %llu dropped\n",
+		async.written, async.dropped);
+
+	free(async.records);
+	async.records = NULL;
+}
+
+void log_async_get_stats(log_async_stats_s *stats)
+{
+	stats->written = async.written;
+	stats->dropped = __atomic_load_n(&async.dropped, __ATOMIC_RELAXED);
+}
+
+static int __log_vprint(log_priority prio, const char *tag, const char *fmt, va_list ap)
+{
+	va_list ap_copy;
+	int async_pushed = 0;
+
+	/* shared producers counter is touched only while async mode runs */
+	if (__atomic_load_n(&async.running, __ATOMIC_ACQUIRE)) {
+		__atomic_fetch_add(&async.producers, 1, __ATOMIC_SEQ_CST);
+		/* recheck, log_async_stop may have started meanwhile */
+		if (__atomic_load_n(&async.running, __ATOMIC_SEQ_CST)) {
+			__log_async_push(prio, tag, fmt, ap);
+			async_pushed = 1;
+		}
+		__atomic_fetch_sub(&async.producers, 1, __ATOMIC_RELEASE);
+		if (async_pushed)
+			return 0;
+	}
 
 	switch (ltype) {
 	case LOG_TYPE_FILE:
 		if (log_fp) {
-			va_start(ap, fmt);
 			fprintf(log_fp, "[%s] [%s]", getFormattedTime(), log_prio_name[prio]);
 			vfprintf(log_fp, fmt, ap);
-			va_end(ap);
 			fflush(log_fp);
 		}
 		break;
 	case LOG_TYPE_ALL:
-		va_start(ap, fmt);
+		va_copy(ap_copy, ap);
 		if (log_fp) {
 			fprintf(log_fp, "[%s] [%s]", getFormattedTime(), log_prio_name[prio]);
-			vfprintf(log_fp, fmt, ap);
+			vfprintf(log_fp, fmt, ap_copy);
 		}
+		va_end(ap_copy);
 		dlog_vprint(prio, tag, fmt, ap);
-		va_end(ap);
 
 		if (log_fp)
 			fflush(log_fp);
 		break;
 	case LOG_TYPE_DLOG:
+	case LOG_TYPE_BINARY:
 	default:
-		va_start(ap, fmt);
 		dlog_vprint(prio, tag, fmt, ap);
-		va_end(ap);
 		break;
 	}
 	return 0;
 }
+
+int log_print(log_priority prio, const char *tag, const char *fmt, ...)
+{
+	va_list ap;
+	int ret;
+
+	va_start(ap, fmt);
+	ret = __log_vprint(prio, tag, fmt, ap);
+	va_end(ap);
+
+	return ret;
+}
+
+int log_print_site(log_site_s *site, log_priority prio, const char *tag, const char *fmt, ...)
+{
+	va_list ap;
+	int ret;
+
+	if (ltype == LOG_TYPE_BINARY && binary.header) {
+		va_start(ap, fmt);
+		__binary_write(site, prio, tag, fmt, ap);
+		va_end(ap);
+
+		/* warnings and errors stay visible in dlog */
+		if (prio < DLOG_WARN)
+			return 0;
+	}
+
+	va_start(ap, fmt);
+	ret = __log_vprint(prio, tag, fmt, ap);
+	va_end(ap);
+
+	return ret;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include "log_binary.h"
+
+#define MAX_STRING_ARG 255
+
+int log_binary_next_conversion(const char *fmt, size_t *pos, log_binary_conversion_s *conv)
+{
+	size_t i = *pos;
+	int longs = 0;
+
+	for (;;) {
+		while (fmt[i] && fmt[i] != '%')
+			i++;
+		if (!fmt[i])
+			return -1;
+
+		memset(conv, 0, sizeof(*conv));
+		conv->start = i++;
+
+		/* flags */
+		while (fmt[i] && strchr("-+ #0'", fmt[i]))
+			i++;
+
+		/* width */
+		if (fmt[i] == '*') {
+			conv->star_width = 1;
+			i++;
+		} else {
+			while (fmt[i] >= '0' && fmt[i] <= '9')
+				i++;
+		}
+
+		/* precision */
+		if (fmt[i] == '.') {
+			i++;
+			if (fmt[i] == '*') {
+				conv->star_precision = 1;
+				i++;
+			} else {
+				while (fmt[i] >= '0' && fmt[i] <= '9')
+					i++;
+			}
+		}
+
+		/* length modifier */
+		longs = 0;
+		conv->type = LOG_BINARY_ARG_INT;
+		switch (fmt[i]) {
+		case 'h':
+			while (fmt[i] == 'h')
+				i++;
+			break;
+		case 'l':
+			while (fmt[i] == 'l') {
+				longs++;
+				i++;
+			}
+			break;
+		case 'z':
+		case 'j':
+		case 't':
+			conv->type = LOG_BINARY_ARG_SIZE;
+			i++;
+			break;
+		case 'L':
+			longs = 2;
+			i++;
+			break;
+		default:
+			break;
+		}
+
+		switch (fmt[i]) {
+		case '%':
+			conv->type = LOG_BINARY_ARG_NONE;
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			conv->is_unsigned = 1;
+			/* fall through */
+		case 'd':
+		case 'i':
+			if (conv->type != LOG_BINARY_ARG_SIZE)
+				conv->type = longs == 0 ? LOG_BINARY_ARG_INT :
+					longs == 1 ? LOG_BINARY_ARG_LONG : LOG_BINARY_ARG_LLONG;
+			break;
+		case 'c':
+			conv->type = LOG_BINARY_ARG_INT;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			conv->type = longs == 2 ? LOG_BINARY_ARG_LDOUBLE : LOG_BINARY_ARG_DOUBLE;
+			break;
+		case 's':
+			conv->type = LOG_BINARY_ARG_STRING;
+			break;
+		case 'p':
+			conv->type = LOG_BINARY_ARG_POINTER;
+			break;
+		case '\0':
+			return -1;
+		default:
+			/* unknown conversion, treat as literal text */
+			continue;
+		}
+
+		conv->end = i + 1;
+		*pos = conv->end;
+		return 0;
+	}
+}
+
+static int _put(uint8_t *payload, size_t size, size_t *used, const void *value, size_t length)
+{
+	if (*used + length > size)
+		return -1;
+
+	memcpy(payload + *used, value, length);
+	*used += length;
+	return 0;
+}
+
+static int _put_int(uint8_t *payload, size_t size, size_t *used, int value)
+{
+	int32_t v = value;
+	return _put(payload, size, used, &v, sizeof(v));
+}
+
+static int _put_int64(uint8_t *payload, size_t size, size_t *used, uint64_t value)
+{
+	return _put(payload, size, used, &value, sizeof(value));
+}
+
+static int _put_string(uint8_t *payload, size_t size, size_t *used, const char *value)
+{
+	size_t length;
+	uint8_t prefix;
+
+	if (!value)
+		value = "(null)";
+
+	length = strnlen(value, MAX_STRING_ARG);
+	if (*used + 1 >= size)
+		return -1;
+
+	/* strings are cut to what fits, rest of arguments is still tried */
+	if (*used + 1 + length > size)
+		length = size - *used - 1;
+
+	prefix = length;
+	_put(payload, size, used, &prefix, 1);
+	_put(payload, size, used, value, length);
+	return 0;
+}
+
+size_t log_binary_pack(uint8_t *payload, size_t size, const char *fmt, size_t fmt_pos,
+	va_list ap, int *truncated)
+{
+	log_binary_conversion_s conv;
+	size_t used = 0;
+	int err = 0;
+	double d;
+
+	*truncated = 0;
+
+	while (!err && !log_binary_next_conversion(fmt, &fmt_pos, &conv)) {
+		if (conv.star_width)
+			err |= _put_int(payload, size, &used, va_arg(ap, int));
+		if (conv.star_precision)
+			err |= _put_int(payload, size, &used, va_arg(ap, int));
+
+		switch (conv.type) {
+		case LOG_BINARY_ARG_NONE:
+			break;
+		case LOG_BINARY_ARG_INT:
+			err |= _put_int(payload, size, &used, va_arg(ap, int));
+			break;
+		case LOG_BINARY_ARG_LONG:
+			if (conv.is_unsigned)
+				err |= _put_int64(payload, size, &used, va_arg(ap, unsigned long));
+			else
+				err |= _put_int64(payload, size, &used, va_arg(ap, long));
+			break;
+		case LOG_BINARY_ARG_LLONG:
+			err |= _put_int64(payload, size, &used, va_arg(ap, unsigned long long));
+			break;
+		case LOG_BINARY_ARG_SIZE:
+			err |= _put_int64(payload, size, &used, va_arg(ap, size_t));
+			break;
+		case LOG_BINARY_ARG_DOUBLE:
+			d = va_arg(ap, double);
+			err |= _put(payload, size, &used, &d, sizeof(d));
+			break;
+		case LOG_BINARY_ARG_LDOUBLE:
+			d = va_arg(ap, long double);
+			err |= _put(payload, size, &used, &d, sizeof(d));
+			break;
+		case LOG_BINARY_ARG_STRING:
+			err |= _put_string(payload, size, &used, va_arg(ap, const char *));
+			break;
+		case LOG_BINARY_ARG_POINTER:
+			err |= _put_int64(payload, size, &used, (uintptr_t)va_arg(ap, void *));
+			break;
+		}
+	}
+
+	*truncated = err != 0;
+	return used;
+}
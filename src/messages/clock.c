@@ -14,37 +14,48 @@
  * limitations under the License.
  */
 
+
 #include <stdlib.h>
 
 #include "messages/clock.h"
 
-float clock_monotonic_get()
+#ifdef CLOCK_MONOTONIC_USE_RAW
+#define MONOTONIC_CLOCK_ID CLOCK_MONOTONIC_RAW
+#else
+#define MONOTONIC_CLOCK_ID CLOCK_MONOTONIC
+#endif
+
+static inline int64_t _clock_ns_get(clockid_t id)
 {
 	struct timespec ret = {0,};
 
-	if (clock_gettime(CLOCK_MONOTONIC, &ret) != 0) {
+	if (clock_gettime(id, &ret) != 0) {
 		abort();
 	}
 
-	return ret.tv_sec + (float)ret.tv_nsec / 1000000000.0f;
+	return (int64_t)ret.tv_sec * CLOCK_NS_PER_SEC + ret.tv_nsec;
 }
 
-time_t clock_realtime_get()
+int64_t clock_monotonic_ns_get()
 {
-	struct timespec ret = {0,};
+	return _clock_ns_get(MONOTONIC_CLOCK_ID);
+}
 
-	if (clock_gettime(CLOCK_REALTIME, &ret) != 0) {
-		abort();
-	}
+int64_t clock_realtime_ns_get()
+{
+	return _clock_ns_get(CLOCK_REALTIME);
+}
 
-	return ret.tv_sec;
+int64_t clock_realtime_ms_get()
+{
+	return clock_realtime_ns_get() / CLOCK_NS_PER_MS;
 }
 
 bool clock_is_supported()
 {
 	struct timespec ret = {0,};
 
-	if (clock_gettime(CLOCK_MONOTONIC, &ret) != 0) {
+	if (clock_gettime(MONOTONIC_CLOCK_ID, &ret) != 0) {
 		return false;
 	}
 	if (clock_gettime(CLOCK_REALTIME, &ret) != 0) {
@@ -52,4 +63,3 @@ bool clock_is_supported()
 	}
 	return true;
 }
-
@@ -15,6 +15,7 @@
 */
 
 #include "messages/message.h"
+#include "messages/message_codec.h"
 
 #include <string.h>
 
@@ -22,56 +23,117 @@ static int64_t current_serial;
 
 void message_destroy(message_t *message)
 {
-	if (message->vtable.destroy)
-		message->vtable.destroy(message);
+	message_base_destroy(message);
 }
 
+#define MESSAGE_ENCODE_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		return message_##name##_encode(writer, container_of(message, message_##name##_t, base));
+
+#define MESSAGE_DECODE_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		err = message_##name##_decode(reader, container_of(message, message_##name##_t, base)); \
+		break;
+
 int message_serialize(message_t *message, writer_t *writer)
 {
-	if (message->vtable.serialize)
-		return message->vtable.serialize(message, writer);
-	return -1;
+	switch (message->type) {
+	MESSAGE_SCHEMA(MESSAGE_ENCODE_CASE)
+	default:
+		return -1;
+	}
 }
 
 int message_deserialize(message_t *message, reader_t *reader)
 {
-	if (message->vtable.deserialize)
-		return message->vtable.deserialize(message, reader);
-	return -1;
+	message_type_e type = message->type;
+	int err;
+
+	switch (type) {
+	MESSAGE_SCHEMA(MESSAGE_DECODE_CASE)
+	default:
+		return -1;
+	}
+
+	return (err || message->type != type) ? -1 : 0;
+}
+
+#define MESSAGE_ENCODE_V2_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		return message_##name##_encode_v2(writer, container_of(message, message_##name##_t, base));
+
+#define MESSAGE_DECODE_V2_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		err = message_##name##_decode_v2(reader, container_of(message, message_##name##_t, base)); \
+		break;
+
+int message_encode(message_t *message, writer_t *writer, message_wire_version_e version)
+{
+	if (version != MESSAGE_WIRE_V2) {
+		if (writer_write_int32(writer, message->type))
+			return -1;
+		return message_serialize(message, writer);
+	}
+
+	switch (message->type) {
+	MESSAGE_SCHEMA(MESSAGE_ENCODE_V2_CASE)
+	default:
+		return -1;
+	}
 }
 
-void message_set_receiver(message_t *message, const char *ip, int port)
+int message_decode(message_t *message, reader_t *reader)
 {
-	if (ip) strncpy(message->receiver_ip, ip, IP_ADDRESS_LEN);
-	message->receiver_port = port;
+	message_type_e type = message->type;
+	int32_t prefix;
+	int err;
+
+	if (reader->offset >= reader->len)
+		return -1;
+
+	if (!(reader->data[reader->offset] & MESSAGE_WIRE_V2_MARK)) {
+		if (reader_read_int32(reader, &prefix) || prefix != type)
+			return -1;
+		return message_deserialize(message, reader);
+	}
+
+	switch (type) {
+	MESSAGE_SCHEMA(MESSAGE_DECODE_V2_CASE)
+	default:
+		return -1;
+	}
+
+	return (err || message->type != type) ? -1 : 0;
 }
 
-void message_get_receiver(message_t *message, const char **ip, int *port)
+void message_set_receiver(message_t *message, const endpoint_t *receiver)
 {
-	if (ip) *ip = message->receiver_ip;
-	if (port) *port = message->receiver_port;
+	message->receiver = *receiver;
 }
 
-time_t message_get_timestamp(message_t *message)
+const endpoint_t *message_get_receiver(message_t *message)
+{
+	return &message->receiver;
+}
+
+int64_t message_get_timestamp(message_t *message)
 {
 	return message->timestamp;
 }
 
-void message_set_timestamp(message_t *message, time_t time)
+void message_set_timestamp(message_t *message, int64_t time)
 {
 	message->timestamp = time;
 }
 
-void message_get_sender(message_t *message, const char **ip, int *port)
+const endpoint_t *message_get_sender(message_t *message)
 {
-	if (ip) *ip = message->sender_ip;
-	if (port) *port = message->sender_port;
+	return &message->sender;
 }
 
-void message_set_sender(message_t *message, const char *ip, int port)
+void message_set_sender(message_t *message, const endpoint_t *sender)
 {
-	if (ip) strncpy(message->sender_ip, ip, IP_ADDRESS_LEN);
-	message->sender_port = port;
+	message->sender = *sender;
 }
 
 message_type_e message_get_type(message_t *message)
@@ -93,34 +155,29 @@ void message_base_init(message_t *msg)
 {
 	memset(msg, 0x0, sizeof(message_t));
 
-	msg->vtable.serialize = message_base_serialize;
-	msg->vtable.deserialize = message_base_deserialize;
-	msg->vtable.destroy = message_base_destroy;
-	msg->serial = current_serial++;
+	msg->serial = message_next_serial();
 }
 
-void message_base_destroy(message_t *msg)
+void message_base_renew(message_t *msg)
 {
+	msg->serial = message_next_serial();
 }
 
-int message_base_deserialize(message_t *msg, reader_t *reader)
+int64_t message_next_serial()
 {
-	int err = 0;
+	return current_serial++;
+}
 
-	err |= reader_read_int64(reader, &msg->serial);
-	err |= reader_read_int32(reader, &msg->type);
-	err |= reader_read_int64(reader, &msg->timestamp);
+void message_base_destroy(message_t *msg)
+{
+}
 
-	return err;
+int message_base_deserialize(message_t *msg, reader_t *reader)
+{
+	return message_codec_read_header(reader, msg);
 }
 
 int message_base_serialize(message_t *msg, writer_t *writer)
 {
-	int err = 0;
-
-	err |= writer_write_int64(writer, msg->serial);
-	err |= writer_write_int32(writer, msg->type);
-	err |= writer_write_int64(writer, msg->timestamp);
-
-	return err;
+	return message_codec_write_header(writer, msg);
 }
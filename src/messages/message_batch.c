@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include "messages/message_batch.h"
+
+int message_batch_append(message_batch_t *message, writer_t *entries, message_t *sub, message_wire_version_e version)
+{
+	size_t start = entries->length;
+	size_t length;
+
+	if (message_get_type(sub) == MESSAGE_BATCH)
+		return -1;
+
+	/* length is patched once sub-message is encoded */
+	if (writer_write_int16(entries, 0) || message_encode(sub, entries, version))
+		goto error;
+
+	length = entries->length - start - sizeof(int16_t);
+	if (length > UINT16_MAX)
+		goto error;
+
+	writer_reset(entries, start);
+	writer_write_int16(entries, (uint16_t)length);
+	writer_reset(entries, start + sizeof(int16_t) + length);
+
+	message->entries.data = entries->data;
+	message->entries.size = entries->length;
+	message->entries.count++;
+	return 0;
+
+error:
+	writer_reset(entries, start);
+	return -1;
+}
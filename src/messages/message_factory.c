@@ -18,50 +18,26 @@
 
 #include "messages/message_factory.h"
 
-#include "messages/message_ack.h"
-#include "messages/message_bye.h"
-#include "messages/message_command.h"
-#include "messages/message_connect.h"
-#include "messages/message_connect_accepted.h"
-#include "messages/message_connect_refused.h"
-#include "messages/message_keep_alive.h"
+#include "messages/message_types.h"
+
+#define MESSAGE_FACTORY_MEMBER(TYPE, name, FIELDS) \
+	message_##name##_t name;
+
+#define MESSAGE_FACTORY_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		message_##name##_init(&factory->messages.name); \
+		return &factory->messages.name.base;
 
 struct _message_factory {
 	union {
-		message_ack_t ack;
-		message_bye_t bye;
-		message_command_t command;
-		message_connect_t connect;
-		message_connect_accepted_t connect_accepted;
-		message_connect_refused_t connect_refused;
-		message_keep_alive_t keep_alive;
+		MESSAGE_SCHEMA(MESSAGE_FACTORY_MEMBER)
 	} messages;
 };
 
 message_t *message_factory_create_message(message_factory_t *factory, message_type_e type)
 {
 	switch(type) {
-	case MESSAGE_CONNECT:
-		message_connect_init(&factory->messages.connect);
-		return &factory->messages.connect.base;
-	case MESSAGE_CONNECT_ACCEPTED:
-		message_connect_accepted_init(&factory->messages.connect_accepted);
-		return &factory->messages.connect_accepted.base;
-	case MESSAGE_CONNECT_REFUSED:
-		message_connect_refused_init(&factory->messages.connect_refused);
-		return &factory->messages.connect_refused.base;
-	case MESSAGE_KEEP_ALIVE:
-		message_keep_alive_init(&factory->messages.keep_alive);
-		return &factory->messages.keep_alive.base;
-	case MESSAGE_ACK:
-		message_ack_init(&factory->messages.ack);
-		return &factory->messages.ack.base;
-	case MESSAGE_COMMAND:
-		message_command_init(&factory->messages.command);
-		return &factory->messages.command.base;
-	case MESSAGE_BYE:
-		message_bye_init(&factory->messages.bye);
-		return &factory->messages.bye.base;
+	MESSAGE_SCHEMA(MESSAGE_FACTORY_CASE)
 	default:
 		return NULL;
 	}
@@ -15,54 +15,130 @@
  */
 
 #include "messages/message_manager.h"
-#include "messages/message_factory.h"
+#include "messages/message_view.h"
 #include "udp_connection.h"
-#include "messages/reader.h"
 #include "messages/writer.h"
 #include "messages/clock.h"
+#include "latency.h"
 
 #define DEFAULT_PORT 4004
+#define DEFAULT_RECEIVE_BATCH_SIZE 16
+#define SEND_BUFFER_SIZE 512
 
 struct _message_mgr {
 	writer_t writer;
-	reader_t reader;
+	char send_buffer[SEND_BUFFER_SIZE];
 	udp_connection_t *conn;
-	message_factory_t *factory;
 	receive_message_cb cb;
 	void *user_data;
+	receive_filter_cb filter_cb;
+	void *filter_user_data;
+	message_view_t pending_command; /* points into receive buffer valid until batch end */
+	latency_trace_s pending_trace;
+	bool has_pending_command;
+	message_manager_stats_s stats;
+	endpoint_t peer;                     /* controller with negotiated wire version */
+	message_wire_version_e peer_version;
+	udp_destination_t peer_destination;  /* resolved once per session */
+	bool receiving;                      /* replies are queued until receive batch ends */
 };
 
 static struct _message_mgr mgr;
 
-static void msg_mgr_udp_receive_cb(const char *data, unsigned int size, const char *address, int port)
+static void msg_mgr_flush_pending_command()
 {
-	int32_t message_type;
-	message_t *message;
-
-	if (!mgr.cb)
+	if (!mgr.has_pending_command)
 		return;
 
-	reader_init_static(&mgr.reader, data, size);
+	mgr.has_pending_command = false;
+	latency_trace_restore(&mgr.pending_trace);
+	if (mgr.cb) mgr.cb(&mgr.pending_command, mgr.user_data);
+}
 
-	if (reader_read_int32(&mgr.reader, &message_type)) {
-		return;
+static void msg_mgr_coalesce_command(const message_view_t *command)
+{
+	const message_view_t *pending = &mgr.pending_command;
+	latency_trace_s trace;
+
+	/* flush below ends current trace, keep the one of this command */
+	latency_trace_save(&trace);
+	mgr.stats.commands_received++;
+
+	if (mgr.has_pending_command) {
+		if (!endpoint_equal(message_view_get_sender(pending), message_view_get_sender(command))) {
+			msg_mgr_flush_pending_command();
+		} else if (message_view_get_serial(command) > message_view_get_serial(pending)) {
+			mgr.stats.commands_coalesced++;
+		} else {
+			mgr.stats.commands_dropped++;
+			return;
+		}
 	}
 
-	message = message_factory_create_message(mgr.factory, message_type);
-	if (!message) {
+	mgr.pending_command = *command;
+	mgr.has_pending_command = true;
+	mgr.pending_trace = trace;
+}
+
+static inline bool msg_mgr_accept(const message_view_t *view)
+{
+	return !mgr.filter_cb || mgr.filter_cb(view, mgr.filter_user_data);
+}
+
+static void msg_mgr_dispatch(const message_view_t *view)
+{
+	if (!msg_mgr_accept(view))
 		return;
-	}
 
-	if (message_deserialize(message, &mgr.reader)) {
-		message_destroy(message);
+	if (message_view_get_type(view) == MESSAGE_COMMAND)
+		msg_mgr_coalesce_command(view);
+	else
+		mgr.cb(view, mgr.user_data);
+}
+
+static void msg_mgr_dispatch_batch(const message_view_t *batch)
+{
+	message_view_batch_iter_t iter;
+	message_view_t sub;
+
+	if (message_view_batch_begin(batch, &iter))
 		return;
+
+	mgr.stats.batches_received++;
+	while (message_view_batch_next(&iter, &sub)) {
+		mgr.stats.batched_messages++;
+		msg_mgr_dispatch(&sub);
 	}
 
-	message_set_sender(message, address, port);
+	/* lets receiver confirm all sub-messages at once */
+	mgr.cb(batch, mgr.user_data);
+}
+
+static void msg_mgr_udp_batch_end_cb(unsigned int count)
+{
+	msg_mgr_flush_pending_command();
+	mgr.receiving = false;
+}
+
+static void msg_mgr_udp_receive_cb(const char *data, unsigned int size, const endpoint_t *sender)
+{
+	message_view_t view;
+
+	mgr.receiving = true;
+
+	if (!mgr.cb)
+		return;
+
+	if (message_view_init(&view, data, size, sender))
+		return;
 
-	if (mgr.cb) mgr.cb(message, mgr.user_data);
+	latency_trace_mark(LATENCY_POINT_DESERIALIZED);
 
-	message_destroy(message);
+	if (message_view_get_type(&view) == MESSAGE_BATCH) {
+		if (msg_mgr_accept(&view))
+			msg_mgr_dispatch_batch(&view);
+	} else
+		msg_mgr_dispatch(&view);
 }
 
 int message_manager_init()
@@ -76,48 +152,105 @@ int message_manager_init()
 		return -1;
 	}
 
-	mgr.factory = message_factory_create();
-	if (!mgr.factory) {
-		message_manager_shutdown();
-		return -1;
-	}
-
 	udp_connection_set_receive_cb(mgr.conn, msg_mgr_udp_receive_cb);
-	writer_init_sized(&mgr.writer, 256);
+	udp_connection_set_batch_end_cb(mgr.conn, msg_mgr_udp_batch_end_cb);
+	udp_connection_set_batch_size(mgr.conn, DEFAULT_RECEIVE_BATCH_SIZE);
+	writer_init_static(&mgr.writer, mgr.send_buffer, sizeof(mgr.send_buffer));
+	mgr.peer_version = MESSAGE_WIRE_V1;
+	udp_destination_init(&mgr.peer_destination, &mgr.peer);
 
 	return 0;
 }
 
+static message_wire_version_e msg_mgr_wire_version(message_t *message)
+{
+	switch (message_get_type(message)) {
+	case MESSAGE_CONNECT:
+	case MESSAGE_CONNECT_ACCEPTED:
+	case MESSAGE_CONNECT_REFUSED:
+		/* handshake has to be readable by controllers of any version */
+		return MESSAGE_WIRE_V1;
+	default:
+		break;
+	}
+
+	if (mgr.peer_version != MESSAGE_WIRE_V1 && endpoint_equal(&mgr.peer, message_get_receiver(message)))
+		return mgr.peer_version;
+
+	return MESSAGE_WIRE_V1;
+}
+
+static int msg_mgr_send(const char *data, size_t size, const endpoint_t *receiver)
+{
+	udp_destination_t destination;
+	const udp_destination_t *dst = &mgr.peer_destination;
+
+	if (!endpoint_equal(receiver, &mgr.peer)) {
+		udp_destination_init(&destination, receiver);
+		dst = &destination;
+	}
+
+	/* replies to received messages leave together when the batch ends */
+	if (mgr.receiving)
+		return udp_connection_queue(mgr.conn, data, size, dst);
+
+	return udp_connection_send_to(mgr.conn, data, size, dst);
+}
+
 int message_manager_send_message(message_t *message)
 {
-	const char *address;
-	int port;
-	int32_t type;
+	if (!mgr.conn)
+		return -1;
+
+	writer_reset(&mgr.writer, 0);
+
+	message_set_timestamp(message, clock_realtime_ms_get());
+
+	if (message_encode(message, &mgr.writer, msg_mgr_wire_version(message)))
+		return -1;
+
+	if (msg_mgr_send(mgr.writer.data, mgr.writer.length, message_get_receiver(message)))
+		return -1;
+
+	return 0;
+}
+
+int message_manager_send_message_to_all(message_t *message, const endpoint_t *receivers, unsigned int count)
+{
+	udp_destination_t destination;
+	unsigned int i;
+	int err = 0;
 
 	if (!mgr.conn)
 		return -1;
 
 	writer_reset(&mgr.writer, 0);
 
-	type = message_get_type(message);
+	message_set_timestamp(message, clock_realtime_ms_get());
 
-	if (writer_write_int32(&mgr.writer, type)) {
+	if (message_encode(message, &mgr.writer, MESSAGE_WIRE_V1))
 		return -1;
+
+	for (i = 0; i < count; i++) {
+		udp_destination_init(&destination, &receivers[i]);
+		err |= udp_connection_queue(mgr.conn, mgr.writer.data, mgr.writer.length, &destination);
 	}
 
-	message_get_receiver(message, &address, &port);
-	message_set_timestamp(message, clock_realtime_get());
+	/* in receive callback the queue is flushed when the batch ends */
+	if (!mgr.receiving)
+		err |= udp_connection_flush(mgr.conn);
+
+	return err ? -1 : 0;
+}
 
-	if (message_serialize(message, &mgr.writer))
+int message_manager_send_prebuilt(message_prebuilt_t *prebuilt, const endpoint_t *receiver)
+{
+	if (!mgr.conn || !prebuilt->size)
 		return -1;
 
-	int err = udp_connection_send(mgr.conn,
-			mgr.writer.data,
-			mgr.writer.length,
-			address,
-			port);
+	message_prebuilt_patch(prebuilt, message_next_serial(), clock_realtime_ms_get());
 
-	if (err)
+	if (msg_mgr_send(prebuilt->data, prebuilt->size, receiver))
 		return -1;
 
 	return 0;
@@ -132,13 +265,36 @@ void message_manager_set_receive_message_cb(receive_message_cb callback, void *u
 	mgr.user_data = user_data;
 }
 
+void message_manager_set_receive_filter_cb(receive_filter_cb callback, void *user_data)
+{
+	if (!mgr.conn)
+		return;
+
+	mgr.filter_cb = callback;
+	mgr.filter_user_data = user_data;
+}
+
+void message_manager_set_peer_version(const endpoint_t *peer, message_wire_version_e version)
+{
+	mgr.peer = *peer;
+	mgr.peer_version = version;
+	udp_destination_init(&mgr.peer_destination, peer);
+}
+
+void message_manager_get_stats(message_manager_stats_s *stats)
+{
+	*stats = mgr.stats;
+}
+
 void message_manager_shutdown()
 {
 	if (!mgr.conn)
 		return;
 
+	mgr.has_pending_command = false;
+	mgr.receiving = false;
+	mgr.peer_version = MESSAGE_WIRE_V1;
 	writer_shutdown(&mgr.writer);
-	message_factory_destroy(mgr.factory);
 	udp_connection_destroy(mgr.conn);
 	mgr.conn = NULL;
 }
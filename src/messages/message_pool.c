@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "messages/message_pool.h"
+#include "messages/message_codec.h"
+
+#define MESSAGE_POOL_MEMBER(TYPE, name, FIELDS) \
+	message_##name##_t name;
+
+#define MESSAGE_POOL_RESET(kind, member, default) \
+	message->member = (message_field_##kind##_t) default;
+
+#define MESSAGE_POOL_CASE(TYPE, name, FIELDS) \
+	case MESSAGE_##TYPE: \
+		return &message_pool_get_##name(pool)->base;
+
+#define MESSAGE_POOL_INIT(TYPE, name, FIELDS) \
+	message_##name##_init(&pool->messages.name);
+
+struct _message_pool {
+	struct {
+		MESSAGE_SCHEMA(MESSAGE_POOL_MEMBER)
+	} messages;
+};
+
+#define MESSAGE_POOL_DEFINE(TYPE, name, FIELDS) \
+	message_##name##_t *message_pool_get_##name(message_pool_t *pool) \
+	{ \
+		message_##name##_t *message = &pool->messages.name; \
+		message_base_renew(&message->base); \
+		FIELDS(MESSAGE_POOL_RESET) \
+		return message; \
+	}
+
+MESSAGE_SCHEMA(MESSAGE_POOL_DEFINE)
+
+message_t *message_pool_get(message_pool_t *pool, message_type_e type)
+{
+	switch (type) {
+	MESSAGE_SCHEMA(MESSAGE_POOL_CASE)
+	default:
+		return NULL;
+	}
+}
+
+message_pool_t *message_pool_create()
+{
+	message_pool_t *pool = malloc(sizeof(message_pool_t));
+
+	if (!pool)
+		return NULL;
+
+	MESSAGE_SCHEMA(MESSAGE_POOL_INIT)
+	return pool;
+}
+
+void message_pool_destroy(message_pool_t *pool)
+{
+	free(pool);
+}
+
+int message_prebuilt_init(message_prebuilt_t *prebuilt, message_t *message)
+{
+	writer_t writer;
+
+	prebuilt->size = 0;
+	writer_init_static(&writer, prebuilt->data, sizeof(prebuilt->data));
+
+	if (message_encode(message, &writer, MESSAGE_WIRE_V1))
+		return -1;
+
+	prebuilt->size = writer.length;
+	return 0;
+}
+
+void message_prebuilt_patch(message_prebuilt_t *prebuilt, int64_t serial, int64_t timestamp)
+{
+	message_codec_patch_header(prebuilt->data, serial, timestamp);
+}
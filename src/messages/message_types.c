@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "messages/message_types.h"
+#include "messages/message_codec.h"
+
+#define MESSAGE_TYPES_DEFAULT(kind, member, default) .member = default,
+
+#define MESSAGE_TYPES_DEFINE(TYPE, name, FIELDS) \
+	void message_##name##_init(message_##name##_t *message) \
+	{ \
+		*message = (message_##name##_t) { \
+			FIELDS(MESSAGE_TYPES_DEFAULT) \
+		}; \
+		message_base_init(&message->base); \
+		message_set_type(&message->base, MESSAGE_##TYPE); \
+	} \
+	void message_##name##_destroy(message_##name##_t *message) \
+	{ \
+		message_base_destroy(&message->base); \
+	} \
+	int message_##name##_deserialize(message_##name##_t *message, reader_t *reader) \
+	{ \
+		return message_##name##_decode(reader, message); \
+	} \
+	int message_##name##_serialize(message_##name##_t *message, writer_t *writer) \
+	{ \
+		return message_##name##_encode(writer, message); \
+	}
+
+MESSAGE_SCHEMA(MESSAGE_TYPES_DEFINE)
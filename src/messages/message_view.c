@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "messages/message_view.h"
+#include "messages/message_codec.h"
+
+int message_view_init(message_view_t *view, const char *data, size_t size, const endpoint_t *sender)
+{
+	reader_t reader;
+	message_t header;
+	int32_t type;
+
+	message_wire_version_e version;
+
+	reader_init_static(&reader, data, size);
+
+	if (size > 0 && (data[0] & MESSAGE_WIRE_V2_MARK)) {
+		version = MESSAGE_WIRE_V2;
+		if (message_codec_read_header_v2(&reader, &header))
+			return -1;
+		type = header.type;
+	} else {
+		version = MESSAGE_WIRE_V1;
+		if (reader_read_int32(&reader, &type))
+			return -1;
+		if (message_codec_read_header(&reader, &header) || header.type != type)
+			return -1;
+	}
+
+	view->payload = data + reader.offset;
+	view->payload_size = size - reader.offset;
+
+	if (message_codec_validate(&reader, type, version))
+		return -1;
+
+	view->type = type;
+	view->version = version;
+	view->serial = header.serial;
+	view->timestamp = header.timestamp;
+	view->sender = *sender;
+	view->in_batch = false;
+
+	return 0;
+}
+
+static inline void _payload_reader_init(const message_view_t *view, reader_t *reader)
+{
+	reader_init_static(reader, view->payload, view->payload_size);
+}
+
+int message_view_get_command(const message_view_t *view, command_s *command)
+{
+	reader_t reader;
+
+	if (view->type != MESSAGE_COMMAND)
+		return -1;
+
+	_payload_reader_init(view, &reader);
+	if (view->version == MESSAGE_WIRE_V2)
+		return message_codec_read_v2_command(&reader, command);
+	return message_codec_read_command(&reader, command);
+}
+
+int message_view_get_ack_serial(const message_view_t *view, int64_t *ack_serial)
+{
+	reader_t reader;
+
+	if (view->type != MESSAGE_ACK)
+		return -1;
+
+	_payload_reader_init(view, &reader);
+	if (view->version == MESSAGE_WIRE_V2)
+		return message_codec_read_v2_int64(&reader, ack_serial);
+	return message_codec_read_int64(&reader, ack_serial);
+}
+
+int message_view_get_peer_version(const message_view_t *view, message_wire_version_e *version)
+{
+	reader_t reader;
+
+	if (view->type != MESSAGE_CONNECT && view->type != MESSAGE_CONNECT_ACCEPTED)
+		return -1;
+
+	_payload_reader_init(view, &reader);
+	if (view->version == MESSAGE_WIRE_V2)
+		return message_codec_read_v2_version(&reader, version);
+	return message_codec_read_version(&reader, version);
+}
+
+int message_view_get_peer_role(const message_view_t *view, message_role_e *role)
+{
+	reader_t reader;
+	message_wire_version_e version;
+
+	if (view->type != MESSAGE_CONNECT && view->type != MESSAGE_CONNECT_ACCEPTED)
+		return -1;
+
+	_payload_reader_init(view, &reader);
+	if (view->version == MESSAGE_WIRE_V2)
+		return message_codec_read_v2_version(&reader, &version) || message_codec_read_v2_role(&reader, role);
+	return message_codec_read_version(&reader, &version) || message_codec_read_role(&reader, role);
+}
+
+int message_view_batch_begin(const message_view_t *view, message_view_batch_iter_t *iter)
+{
+	message_field_batch_t entries;
+
+	if (view->type != MESSAGE_BATCH)
+		return -1;
+
+	_payload_reader_init(view, &iter->reader);
+	if (view->version == MESSAGE_WIRE_V2) {
+		if (message_codec_read_v2_batch(&iter->reader, &entries))
+			return -1;
+	} else if (message_codec_read_batch(&iter->reader, &entries)) {
+		return -1;
+	}
+
+	reader_init_static(&iter->reader, entries.data, entries.size);
+	iter->left = entries.count;
+	iter->sender = view->sender;
+	return 0;
+}
+
+bool message_view_batch_next(message_view_batch_iter_t *iter, message_view_t *sub)
+{
+	int16_t length;
+	const char *data;
+
+	while (iter->left > 0) {
+		iter->left--;
+
+		/* framing was checked when the batch view was initialized */
+		if (reader_read_int16(&iter->reader, &length))
+			return false;
+		data = reader_take(&iter->reader, (uint16_t)length);
+		if (!data)
+			return false;
+
+		if (message_view_init(sub, data, (uint16_t)length, &iter->sender))
+			continue;
+		if (sub->type == MESSAGE_BATCH)
+			continue;
+
+		sub->in_batch = true;
+		return true;
+	}
+
+	return false;
+}
@@ -32,28 +32,67 @@ void reader_reset(reader_t *reader)
 	reader->offset = 0;
 }
 
-int reader_read_int32(reader_t *reader, int32_t *value)
+int reader_read_int16(reader_t *reader, int16_t *value)
 {
-	if (reader->offset + sizeof(*value) > reader->len)
+	const char *data = reader_take(reader, sizeof(*value));
+
+	if (!data)
 		return -1;
 
-	*value = be32toh(*(uint32_t*)&reader->data[reader->offset]);
+	*value = reader_load_be16(data);
+	return 0;
+}
 
-	reader->offset += sizeof(*value);
+int reader_read_int32(reader_t *reader, int32_t *value)
+{
+	const char *data = reader_take(reader, sizeof(*value));
+
+	if (!data)
+		return -1;
+
+	*value = reader_load_be32(data);
 	return 0;
 }
 
 int reader_read_int64(reader_t *reader, int64_t *value)
 {
-	if (reader->offset + sizeof(*value) > reader->len)
-		return -1;
+	const char *data = reader_take(reader, sizeof(*value));
 
-	*value = be64toh(*(int64_t*)&reader->data[reader->offset]);
+	if (!data)
+		return -1;
 
-	reader->offset += sizeof(*value);
+	*value = reader_load_be64(data);
 	return 0;
 }
 
+int reader_read_varint(reader_t *reader, uint64_t *value)
+{
+	uint64_t result = 0;
+	unsigned int shift;
+	unsigned char byte;
+
+	/* single byte values are the common case: types, small serials */
+	if (reader->offset < reader->len && !(reader->data[reader->offset] & 0x80)) {
+		*value = (unsigned char)reader->data[reader->offset++];
+		return 0;
+	}
+
+	for (shift = 0; shift < 64; shift += 7) {
+		if (reader->offset >= reader->len)
+			return -1;
+
+		byte = reader->data[reader->offset++];
+		result |= (uint64_t)(byte & 0x7f) << shift;
+
+		if (!(byte & 0x80)) {
+			*value = result;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
 int reader_read_bool(reader_t *reader, bool *value)
 {
 	char val;
@@ -77,24 +116,33 @@ int reader_read_char(reader_t *reader, char *value)
 	return 0;
 }
 
-int reader_read_string(reader_t *reader, char **value)
+int reader_read_string_view(reader_t *reader, const char **value, size_t *length)
 {
+	size_t offset = reader->offset;
 	int32_t len;
-	char *ret;
 
-	if (reader_read_int32(reader, &len)) {
-		return -1;
-	}
+	if (reader_read_int32(reader, &len) || len < 0)
+		goto fail;
 
-	if (len < 0)
-		return -1;
+	*value = reader_take(reader, len);
+	if (!*value)
+		goto fail;
 
-	if (len == 0) {
-		*value = strdup("");
-		return 0;
-	}
+	*length = len;
+	return 0;
+
+fail:
+	reader->offset = offset;
+	return -1;
+}
 
-	if (reader->offset + len > reader->len)
+int reader_read_string(reader_t *reader, char **value)
+{
+	const char *view;
+	size_t len;
+	char *ret;
+
+	if (reader_read_string_view(reader, &view, &len))
 		return -1;
 
 	ret = (char*)malloc(sizeof(char) * (len + 1));
@@ -102,9 +150,7 @@ int reader_read_string(reader_t *reader, char **value)
 		return -1;
 	}
 
-	memcpy(ret, &reader->data[reader->offset], len);
-	reader->offset += len;
-
+	memcpy(ret, view, len);
 	ret[len] = '\0';
 	*value = ret;
 	return 0;
@@ -20,37 +20,74 @@
 #include <stdint.h>
 #include <string.h>
 
+#define WRITER_MIN_CAPACITY 64
+
 int writer_init_sized(writer_t *writer, size_t length)
 {
 	writer->data = malloc(length);
 	writer->length = 0;
-	writer->cap = length;
+	writer->cap = writer->data ? length : 0;
+	writer->fixed = false;
 
 	return writer->data ? 0 : -1;
 }
 
-static int _writer_resize_buffer(writer_t *writer, size_t new_size)
+void writer_init_static(writer_t *writer, char *storage, size_t size)
 {
-	writer->data = realloc(writer->data, new_size);
-	writer->cap = new_size;
+	writer->data = storage;
+	writer->length = 0;
+	writer->cap = size;
+	writer->fixed = true;
+}
 
-	return writer->data ? 0 : -1;
+static int _writer_grow(writer_t *writer, size_t needed)
+{
+	size_t new_cap;
+	char *data;
+
+	if (writer->fixed)
+		return -1;
+
+	new_cap = writer->cap < WRITER_MIN_CAPACITY ? WRITER_MIN_CAPACITY : writer->cap;
+	while (new_cap < needed)
+		new_cap *= 2;
+
+	/* on failure old buffer stays valid and owned by writer */
+	data = realloc(writer->data, new_cap);
+	if (!data)
+		return -1;
+
+	writer->data = data;
+	writer->cap = new_cap;
+	return 0;
+}
+
+int writer_reserve(writer_t *writer, size_t length)
+{
+	if (writer->length + length <= writer->cap)
+		return 0;
+
+	return _writer_grow(writer, writer->length + length);
 }
 
-static int _writer_bytes_append(writer_t *writer, void *buf, size_t len)
+static int _writer_bytes_append(writer_t *writer, const void *buf, size_t len)
 {
-	if (writer->length + len >= writer->cap)
-		if (_writer_resize_buffer(writer, writer->cap + len))
-			return -1;
+	if (writer_reserve(writer, len))
+		return -1;
 
-	memcpy(&writer->data[writer->length], (char*)buf, len);
+	memcpy(&writer->data[writer->length], buf, len);
 	writer->length += len;
 	return 0;
 }
 
 void writer_shutdown(writer_t *writer)
 {
-	free(writer->data);
+	if (!writer->fixed)
+		free(writer->data);
+
+	writer->data = NULL;
+	writer->length = 0;
+	writer->cap = 0;
 }
 
 void writer_reset(writer_t *writer, size_t position)
@@ -58,6 +95,12 @@ void writer_reset(writer_t *writer, size_t position)
 	writer->length = position > writer->cap ? writer->cap : position;
 }
 
+int writer_write_int16(writer_t *writer, int16_t value)
+{
+	int16_t converted = htobe16(value);
+	return _writer_bytes_append(writer, &converted, sizeof(converted));
+}
+
 int writer_write_int32(writer_t *writer, int32_t value)
 {
 	int32_t converted = htobe32(value);
@@ -70,6 +113,21 @@ int writer_write_int64(writer_t *writer, int64_t value)
 	return _writer_bytes_append(writer, &converted, sizeof(converted));
 }
 
+int writer_write_varint(writer_t *writer, uint64_t value)
+{
+	unsigned char tmp[10];
+	size_t len = 0;
+
+	/* encode locally so fixed buffers only need room for the bytes produced */
+	while (value >= 0x80) {
+		tmp[len++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	tmp[len++] = value;
+
+	return _writer_bytes_append(writer, tmp, len);
+}
+
 int writer_write_bool(writer_t *writer, bool value)
 {
 	return writer_write_char(writer, value ? 1 : 0);
@@ -86,5 +144,10 @@ int writer_write_string(writer_t *writer, const char *value)
 	if (writer_write_int32(writer, len)) {
 		return -1;
 	}
-	return _writer_bytes_append(writer, (void*)value, sizeof(char) * len);
+	return _writer_bytes_append(writer, value, sizeof(char) * len);
+}
+
+int writer_write_bytes(writer_t *writer, const void *data, size_t length)
+{
+	return _writer_bytes_append(writer, data, length);
 }
@@ -21,6 +21,7 @@
 #include <math.h>
 #include <peripheral_io.h>
 #include "log.h"
+#include "messages/clock.h"
 #include "resource/resource_PCA9685.h"
 
 #define RPI3_I2C_BUS 1
@@ -44,19 +45,114 @@
 
 /* Bits: */
 #define RESTART            0x80
+#define AI                 0x20
 #define SLEEP              0x10
 #define ALLCALL            0x01
 #define INVRT              0x10
 #define OUTDRV             0x04
 
+#define CHANNEL_REG_COUNT  4
+
 typedef enum {
 	PCA9685_CH_STATE_NONE,
 	PCA9685_CH_STATE_USED,
 } pca9685_ch_state_e;
 
+typedef struct {
+	bool valid;
+	int on;
+	int off;
+} pca9685_shadow_s;
+
 static peripheral_i2c_h g_i2c_h = NULL;
 static unsigned int ref_count = 0;
 static pca9685_ch_state_e ch_state[PCA9685_CH_MAX + 1] = {PCA9685_CH_STATE_NONE, };
+static bool burst_write = true;
+static pca9685_stats_s stats = {0, };
+static pca9685_shadow_s shadow[PCA9685_CH_MAX + 1] = { {false, 0, 0}, };
+
+static int __write_register_byte(uint8_t reg, uint8_t value)
+{
+	int64_t start = clock_monotonic_ns_get();
+	int ret = peripheral_i2c_write_register_byte(g_i2c_h, reg, value);
+
+	stats.time_ns += clock_monotonic_ns_get() - start;
+	stats.transactions++;
+	stats.bytes += 2;
+
+	return ret;
+}
+
+static int __write_burst(uint8_t *data, uint32_t length)
+{
+	int64_t start = clock_monotonic_ns_get();
+	int ret = peripheral_i2c_write(g_i2c_h, data, length);
+
+	stats.time_ns += clock_monotonic_ns_get() - start;
+	stats.transactions++;
+	stats.bytes += length;
+
+	return ret;
+}
+
+static inline void __fill_channel_regs(uint8_t *regs, int on, int off)
+{
+	regs[0] = on & 0xFF;
+	regs[1] = on >> 8;
+	regs[2] = off & 0xFF;
+	regs[3] = off >> 8;
+}
+
+static inline bool __shadow_matches(const pca9685_channel_value_s *value)
+{
+	const pca9685_shadow_s *sh = &shadow[value->channel];
+
+	return sh->valid && sh->on == value->on && sh->off == value->off;
+}
+
+static inline void __shadow_update(const pca9685_channel_value_s *values, unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		shadow[values[i].channel].valid = true;
+		shadow[values[i].channel].on = values[i].on;
+		shadow[values[i].channel].off = values[i].off;
+	}
+}
+
+/* writes ON_L, ON_H, OFF_L and OFF_H of count consecutive channels starting at base register */
+static int __write_channel_regs(uint8_t base, const pca9685_channel_value_s *values, unsigned int count)
+{
+	uint8_t data[1 + CHANNEL_REG_COUNT * (PCA9685_CH_MAX + 1)];
+	unsigned int i;
+	int ret = PERIPHERAL_ERROR_NONE;
+
+	for (i = 0; i < count; i++)
+		__fill_channel_regs(&data[1 + i * CHANNEL_REG_COUNT], values[i].on, values[i].off);
+
+	if (burst_write) {
+		data[0] = base;
+		ret = __write_burst(data, 1 + count * CHANNEL_REG_COUNT);
+		if (ret != PERIPHERAL_ERROR_NONE) {
+			_E("failed to write registers");
+			resource_pca9685_invalidate_cache();
+			return -1;
+		}
+		return 0;
+	}
+
+	for (i = 0; i < count * CHANNEL_REG_COUNT; i++) {
+		ret = __write_register_byte(base + i, data[1 + i]);
+		if (ret != PERIPHERAL_ERROR_NONE) {
+			_E("failed to write register");
+			resource_pca9685_invalidate_cache();
+			return -1;
+		}
+	}
+
+	return 0;
+}
 
 int resource_pca9685_set_frequency(unsigned int freq_hz)
 {
@@ -77,18 +173,18 @@ int resource_pca9685_set_frequency(unsigned int freq_hz)
 	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to read register");
 
 	newmode = (oldmode & 0x7F) | 0x10; // sleep
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, MODE1, newmode); // go to sleep
+	ret = __write_register_byte(MODE1, newmode); // go to sleep
 	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, PRESCALE, prescale);
+	ret = __write_register_byte(PRESCALE, prescale);
 	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, MODE1, oldmode);
+	ret = __write_register_byte(MODE1, oldmode);
 	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
 
 	usleep(500);
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, MODE1, (oldmode | 0x80));
+	ret = __write_register_byte(MODE1, (oldmode | RESTART));
 	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
 
 	return 0;
@@ -96,55 +192,140 @@ int resource_pca9685_set_frequency(unsigned int freq_hz)
 
 int resource_pca9685_set_value_to_channel(unsigned int channel, int on, int off)
 {
-	int ret = PERIPHERAL_ERROR_NONE;
+	pca9685_channel_value_s value = { channel, on, off };
+
 	retvm_if(g_i2c_h == NULL, -1, "Not initialized yet");
 
+	retvm_if(channel > PCA9685_CH_MAX, -1, "ch[%u] is out of range", channel);
+
 	retvm_if(ch_state[channel] == PCA9685_CH_STATE_NONE, -1,
 		"ch[%u] is not in used state", channel);
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-			LED0_ON_L + 4*channel, on & 0xFF);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+	if (__shadow_matches(&value)) {
+		stats.cache_hits++;
+		return 0;
+	}
+	stats.cache_misses++;
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-			LED0_ON_H + 4*channel, on >> 8);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+	if (__write_channel_regs(LED0_ON_L + CHANNEL_REG_COUNT * channel, &value, 1))
+		return -1;
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-			LED0_OFF_L + 4*channel, off & 0xFF);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+	__shadow_update(&value, 1);
+	return 0;
+}
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-			LED0_OFF_H + 4*channel, off >> 8);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+int resource_pca9685_set_values_to_channels(const pca9685_channel_value_s *values, unsigned int count)
+{
+	pca9685_channel_value_s changed[PCA9685_CH_MAX + 1];
+	unsigned int changed_count = 0;
+	unsigned int i;
+	unsigned int start = 0;
+	int ret;
+
+	retvm_if(g_i2c_h == NULL, -1, "Not initialized yet");
+	retvm_if(count > PCA9685_CH_MAX + 1, -1, "too many channels[%u]", count);
+
+	for (i = 0; i < count; i++) {
+		retvm_if(values[i].channel > PCA9685_CH_MAX, -1,
+			"ch[%u] is out of range", values[i].channel);
+		retvm_if(ch_state[values[i].channel] == PCA9685_CH_STATE_NONE, -1,
+			"ch[%u] is not in used state", values[i].channel);
+
+		if (__shadow_matches(&values[i])) {
+			stats.cache_hits++;
+			continue;
+		}
+		stats.cache_misses++;
+		changed[changed_count++] = values[i];
+	}
+
+	for (i = 1; i <= changed_count; i++) {
+		if (i < changed_count && changed[i].channel == changed[i - 1].channel + 1)
+			continue;
+
+		ret = __write_channel_regs(LED0_ON_L + CHANNEL_REG_COUNT * changed[start].channel,
+			&changed[start], i - start);
+		if (ret)
+			return -1;
+
+		__shadow_update(&changed[start], i - start);
+		start = i;
+	}
 
 	return 0;
 }
 
 static int resource_pca9685_set_value_to_all(int on, int off)
 {
-	int ret = PERIPHERAL_ERROR_NONE;
+	pca9685_channel_value_s value = { 0, on, off };
+	unsigned int ch;
+
 	retvm_if(g_i2c_h == NULL, -1, "Not initialized yet");
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-		ALL_LED_ON_L, on & 0xFF);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+	if (__write_channel_regs(ALL_LED_ON_L, &value, 1))
+		return -1;
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-		ALL_LED_ON_H, on >> 8);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+	/* ALL_LED registers load every LEDn register at once */
+	for (ch = 0; ch <= PCA9685_CH_MAX; ch++) {
+		value.channel = ch;
+		__shadow_update(&value, 1);
+	}
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-		ALL_LED_OFF_L, off & 0xFF);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+	return 0;
+}
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h,
-		ALL_LED_OFF_H, off >> 8);
-	retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to write register");
+void resource_pca9685_set_burst_write(bool enable)
+{
+	burst_write = enable;
+}
+
+void resource_pca9685_invalidate_cache(void)
+{
+	unsigned int ch;
+
+	for (ch = 0; ch <= PCA9685_CH_MAX; ch++)
+		shadow[ch].valid = false;
+}
+
+int resource_pca9685_resync_cache(void)
+{
+	uint8_t regs[CHANNEL_REG_COUNT];
+	unsigned int ch;
+	unsigned int i;
+	int ret;
+
+	retvm_if(g_i2c_h == NULL, -1, "Not initialized yet");
+
+	resource_pca9685_invalidate_cache();
+
+	for (ch = 0; ch <= PCA9685_CH_MAX; ch++) {
+		for (i = 0; i < CHANNEL_REG_COUNT; i++) {
+			ret = peripheral_i2c_read_register_byte(g_i2c_h,
+				LED0_ON_L + CHANNEL_REG_COUNT * ch + i, &regs[i]);
+			retvm_if(ret != PERIPHERAL_ERROR_NONE, -1, "failed to read register");
+		}
+		shadow[ch].on = regs[0] | (regs[1] << 8);
+		shadow[ch].off = regs[2] | (regs[3] << 8);
+		shadow[ch].valid = true;
+	}
 
 	return 0;
 }
 
+void resource_pca9685_get_stats(pca9685_stats_s *out)
+{
+	*out = stats;
+}
+
+void resource_pca9685_reset_stats(void)
+{
+	stats.transactions = 0;
+	stats.bytes = 0;
+	stats.time_ns = 0;
+	stats.cache_hits = 0;
+	stats.cache_misses = 0;
+}
+
 int resource_pca9685_init(unsigned int ch)
 {
 	uint8_t mode1 = 0;
@@ -169,19 +350,20 @@ int resource_pca9685_init(unsigned int ch)
 			RPI3_I2C_BUS, PCA9685_ADDRESS);
 		return -1;
 	}
-	ret = resource_pca9685_set_value_to_all(0, 0);
-	if (ret) {
-		_E("failed to reset all value to register");
+	/* enable register auto-increment first, so channels can be written in bursts */
+	ret = __write_register_byte(MODE1, ALLCALL | AI);
+	if (ret != PERIPHERAL_ERROR_NONE) {
+		_E("failed to write register");
 		goto ERROR;
 	}
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, MODE2, OUTDRV);
-	if (ret != PERIPHERAL_ERROR_NONE) {
-		_E("failed to write register");
+	ret = resource_pca9685_set_value_to_all(0, 0);
+	if (ret) {
+		_E("failed to reset all value to register");
 		goto ERROR;
 	}
 
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, MODE1, ALLCALL);
+	ret = __write_register_byte(MODE2, OUTDRV);
 	if (ret != PERIPHERAL_ERROR_NONE) {
 		_E("failed to write register");
 		goto ERROR;
@@ -196,7 +378,7 @@ int resource_pca9685_init(unsigned int ch)
 	}
 
 	mode1 = mode1 & (~SLEEP); // # wake up (reset sleep)
-	ret = peripheral_i2c_write_register_byte(g_i2c_h, MODE1, mode1);
+	ret = __write_register_byte(MODE1, mode1);
 	if (ret != PERIPHERAL_ERROR_NONE) {
 		_E("failed to write register");
 		goto ERROR;
@@ -223,6 +405,7 @@ ERROR:
 		peripheral_i2c_close(g_i2c_h);
 
 	g_i2c_h = NULL;
+	resource_pca9685_invalidate_cache();
 	return -1;
 }
 
@@ -240,9 +423,13 @@ int resource_pca9685_fini(unsigned int ch)
 
 	if (ref_count == 0 && g_i2c_h) {
 		_D("finalizing pca9685");
+		_I("pca9685 - %llu i2c transactions, %llu bytes, %llu us, cache %llu hits/%llu misses",
+			stats.transactions, stats.bytes, stats.time_ns / 1000,
+			stats.cache_hits, stats.cache_misses);
 		resource_pca9685_set_value_to_all(0, 0);
 		peripheral_i2c_close(g_i2c_h);
 		g_i2c_h = NULL;
+		resource_pca9685_invalidate_cache();
 	}
 
 	return 0;
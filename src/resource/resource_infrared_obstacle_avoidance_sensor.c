@@ -75,7 +75,7 @@ int resource_read_infrared_obstacle_avoidance_sensor(int pin_num, unsigned int *
 
 	*out_value = !*out_value;
 
-	_I("Infrared Obstacle Avoidance Sensor Value : %d", *out_value);
+	_D("Infrared Obstacle Avoidance Sensor Value : %d", *out_value);
 
 	return 0;
 }
@@ -30,6 +30,8 @@ typedef enum {
 	MOTOR_STATE_BACKWARD,
 } motor_state_e;
 
+#define PIN_VALUE_UNKNOWN -1
+
 typedef struct __motor_driver_s {
 	unsigned int pin_1;
 	unsigned int pin_2;
@@ -37,12 +39,32 @@ typedef struct __motor_driver_s {
 	motor_state_e motor_state;
 	peripheral_gpio_h pin1_h;
 	peripheral_gpio_h pin2_h;
+	int pin1_v;
+	int pin2_v;
 } motor_driver_s;
 
 static motor_driver_s g_md_h[MOTOR_ID_MAX] = {
-	{0, 0, 0, MOTOR_STATE_NONE, NULL, NULL},
+	{0, 0, 0, MOTOR_STATE_NONE, NULL, NULL, PIN_VALUE_UNKNOWN, PIN_VALUE_UNKNOWN},
 };
 
+static motor_driver_L298N_stats_s g_stats = {0, };
+
+static int __gpio_write_cached(peripheral_gpio_h pin_h, int *cached, int value)
+{
+	int ret = PERIPHERAL_ERROR_NONE;
+
+	if (*cached == value) {
+		g_stats.hits++;
+		return PERIPHERAL_ERROR_NONE;
+	}
+	g_stats.misses++;
+
+	ret = peripheral_gpio_write(pin_h, value);
+	*cached = (ret == PERIPHERAL_ERROR_NONE) ? value : PIN_VALUE_UNKNOWN;
+
+	return ret;
+}
+
 
 /* see Principle section in http://wiki.sunfounder.cc/index.php?title=Motor_Driver_Module-L298N */
 
@@ -72,13 +94,13 @@ static int __motor_brake_n_stop_by_id(motor_id_e id)
 	}
 
 	/* Brake DC motor */
-	ret = peripheral_gpio_write(g_md_h[id].pin1_h, motor1_v);
+	ret = __gpio_write_cached(g_md_h[id].pin1_h, &g_md_h[id].pin1_v, motor1_v);
 	if (ret != PERIPHERAL_ERROR_NONE) {
 		_E("Failed to set value[%d] Motor[%d] pin 1", motor1_v, id);
 		return -1;
 	}
 
-	ret = peripheral_gpio_write(g_md_h[id].pin2_h, motor2_v);
+	ret = __gpio_write_cached(g_md_h[id].pin2_h, &g_md_h[id].pin2_v, motor2_v);
 	if (ret != PERIPHERAL_ERROR_NONE) {
 		_E("Failed to set value[%d] Motor[%d] pin 2", motor2_v, id);
 		return -1;
@@ -128,6 +150,8 @@ static int __set_default_configuration_by_id(motor_id_e id)
 	g_md_h[id].pin_1 = pin_1;
 	g_md_h[id].pin_2 = pin_2;
 	g_md_h[id].en_ch = en_ch;
+	g_md_h[id].pin1_v = PIN_VALUE_UNKNOWN;
+	g_md_h[id].pin2_v = PIN_VALUE_UNKNOWN;
 	g_md_h[id].motor_state = MOTOR_STATE_CONFIGURED;
 
 	return 0;
@@ -155,6 +179,8 @@ static int __fini_motor_by_id(motor_id_e id)
 		g_md_h[id].pin2_h = NULL;
 	}
 
+	g_md_h[id].pin1_v = PIN_VALUE_UNKNOWN;
+	g_md_h[id].pin2_v = PIN_VALUE_UNKNOWN;
 	g_md_h[id].motor_state = MOTOR_STATE_CONFIGURED;
 
 	return 0;
@@ -177,19 +203,21 @@ static int __init_motor_by_id(motor_id_e id)
 
 	/* open pins for Motor */
 	ret = peripheral_gpio_open(g_md_h[id].pin_1, &g_md_h[id].pin1_h);
-	if (ret == PERIPHERAL_ERROR_NONE)
-		peripheral_gpio_set_direction(g_md_h[id].pin1_h,
+	if (ret == PERIPHERAL_ERROR_NONE) {
+		ret = peripheral_gpio_set_direction(g_md_h[id].pin1_h,
 			PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_LOW);
-	else {
+		g_md_h[id].pin1_v = (ret == PERIPHERAL_ERROR_NONE) ? 0 : PIN_VALUE_UNKNOWN;
+	} else {
 		_E("failed to open Motor[%d] gpio pin1[%u]", id, g_md_h[id].pin_1);
 		goto ERROR;
 	}
 
 	ret = peripheral_gpio_open(g_md_h[id].pin_2, &g_md_h[id].pin2_h);
-	if (ret == PERIPHERAL_ERROR_NONE)
-		peripheral_gpio_set_direction(g_md_h[id].pin2_h,
+	if (ret == PERIPHERAL_ERROR_NONE) {
+		ret = peripheral_gpio_set_direction(g_md_h[id].pin2_h,
 			PERIPHERAL_GPIO_DIRECTION_OUT_INITIALLY_LOW);
-	else {
+		g_md_h[id].pin2_v = (ret == PERIPHERAL_ERROR_NONE) ? 0 : PIN_VALUE_UNKNOWN;
+	} else {
 		_E("failed to open Motor[%d] gpio pin2[%u]", id, g_md_h[id].pin_2);
 		goto ERROR;
 	}
@@ -214,6 +242,20 @@ ERROR:
 	return -1;
 }
 
+void resource_motor_driver_L298N_invalidate_cache(void)
+{
+	int i;
+	for (i = MOTOR_ID_1; i < MOTOR_ID_MAX; i++) {
+		g_md_h[i].pin1_v = PIN_VALUE_UNKNOWN;
+		g_md_h[i].pin2_v = PIN_VALUE_UNKNOWN;
+	}
+}
+
+void resource_motor_driver_L298N_get_stats(motor_driver_L298N_stats_s *stats)
+{
+	*stats = g_stats;
+}
+
 void resource_close_motor_driver_L298N(motor_id_e id)
 {
 	__fini_motor_by_id(id);
@@ -242,6 +284,8 @@ int resource_set_motor_driver_L298N_configuration(motor_id_e id,
 	g_md_h[id].pin_1 = pin1;
 	g_md_h[id].pin_2 = pin2;
 	g_md_h[id].en_ch = en_ch;
+	g_md_h[id].pin1_v = PIN_VALUE_UNKNOWN;
+	g_md_h[id].pin2_v = PIN_VALUE_UNKNOWN;
 	g_md_h[id].motor_state = MOTOR_STATE_CONFIGURED;
 
 	return 0;
@@ -259,7 +303,7 @@ int resource_set_motor_driver_L298N_speed(motor_id_e id, int speed)
 	if (g_md_h[id].motor_state <= MOTOR_STATE_CONFIGURED) {
 		ret = __init_motor_by_id(id);
 		if (ret) {
-			_E("failed to __init_motor_by_id()");
+			_E_RL(1, "failed to __init_motor_by_id()");
 			return -1;
 		}
 	}
@@ -276,7 +320,7 @@ int resource_set_motor_driver_L298N_speed(motor_id_e id, int speed)
 		/* brake and stop */
 		ret = __motor_brake_n_stop_by_id(id);
 		if (ret) {
-			_E("failed to stop motor[%d]", id);
+			_E_RL(1, "failed to stop motor[%d]", id);
 			return -1;
 		}
 		return 0; /* done */
@@ -293,7 +337,7 @@ int resource_set_motor_driver_L298N_speed(motor_id_e id, int speed)
 		/* brake and stop */
 		ret = __motor_brake_n_stop_by_id(id);
 		if (ret) {
-			_E("failed to stop motor[%d]", id);
+			_E_RL(1, "failed to stop motor[%d]", id);
 			return -1;
 		}
 	}
@@ -308,22 +352,22 @@ int resource_set_motor_driver_L298N_speed(motor_id_e id, int speed)
 		motor_v_2 = 1;
 		break;
 	}
-	ret = peripheral_gpio_write(g_md_h[id].pin1_h, motor_v_1);
+	ret = __gpio_write_cached(g_md_h[id].pin1_h, &g_md_h[id].pin1_v, motor_v_1);
 	if (ret != PERIPHERAL_ERROR_NONE) {
-		_E("failed to set value[%d] Motor[%d] pin 1", motor_v_1, id);
+		_E_RL(1, "failed to set value[%d] Motor[%d] pin 1", motor_v_1, id);
 		return -1;
 	}
 
-	ret = peripheral_gpio_write(g_md_h[id].pin2_h, motor_v_2);
+	ret = __gpio_write_cached(g_md_h[id].pin2_h, &g_md_h[id].pin2_v, motor_v_2);
 	if (ret != PERIPHERAL_ERROR_NONE) {
-		_E("failed to set value[%d] Motor[%d] pin 2", motor_v_2, id);
+		_E_RL(1, "failed to set value[%d] Motor[%d] pin 2", motor_v_2, id);
 		return -1;
 	}
 
 SET_SPEED:
 	ret = resource_pca9685_set_value_to_channel(g_md_h[id].en_ch, 0, value);
 	if (ret) {
-		_E("failed to set speed - %d", speed);
+		_E_RL(1, "failed to set speed - %d", speed);
 		return -1;
 	}
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "serial_window.h"
+
+#include <string.h>
+
+void serial_window_init(serial_window_t *window)
+{
+	memset(window, 0x0, sizeof(*window));
+}
+
+serial_window_result_e serial_window_update(serial_window_t *window, int64_t serial)
+{
+	uint64_t offset;
+	uint64_t bit;
+
+	if (!window->synced || serial > window->max) {
+		offset = window->synced ? (uint64_t)serial - (uint64_t)window->max : SERIAL_WINDOW_SIZE;
+		window->bitmap = offset < SERIAL_WINDOW_SIZE ? window->bitmap << offset | 1 : 1;
+		window->max = serial;
+		window->synced = true;
+		window->stats.new++;
+		return SERIAL_WINDOW_NEW;
+	}
+
+	offset = (uint64_t)window->max - (uint64_t)serial;
+	if (offset >= SERIAL_WINDOW_SIZE) {
+		window->stats.stale++;
+		return SERIAL_WINDOW_STALE;
+	}
+
+	bit = (uint64_t)1 << offset;
+	if (window->bitmap & bit) {
+		window->stats.duplicate++;
+		return SERIAL_WINDOW_DUPLICATE;
+	}
+
+	window->bitmap |= bit;
+	window->stats.late++;
+	return SERIAL_WINDOW_LATE;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spsc_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int spsc_queue_init(spsc_queue_t *queue, unsigned int capacity, size_t element_size)
+{
+	if (capacity == 0 || (capacity & (capacity - 1)))
+		return -1;
+
+	queue->buffer = calloc(capacity, element_size);
+	if (!queue->buffer)
+		return -1;
+
+	queue->element_size = element_size;
+	queue->mask = capacity - 1;
+	queue->head = 0;
+	queue->tail = 0;
+	return 0;
+}
+
+void spsc_queue_shutdown(spsc_queue_t *queue)
+{
+	free(queue->buffer);
+	queue->buffer = NULL;
+}
+
+int spsc_queue_push(spsc_queue_t *queue, const void *element)
+{
+	unsigned int tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+	unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+	if (tail - head > queue->mask)
+		return -1;
+
+	memcpy(&queue->buffer[(tail & queue->mask) * queue->element_size], element, queue->element_size);
+	__atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+int spsc_queue_pop(spsc_queue_t *queue, void *element)
+{
+	unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	unsigned int tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+	if (head == tail)
+		return -1;
+
+	memcpy(element, &queue->buffer[(head & queue->mask) * queue->element_size], queue->element_size);
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+bool spsc_queue_is_empty(spsc_queue_t *queue)
+{
+	return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * Licensed under the Flora License, Version 1.1 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://floralicense.org/license/
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "timer_wheel.h"
+
+#include <string.h>
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) ((level) * TIMER_WHEEL_BITS)
+
+void timer_wheel_init(timer_wheel_t *wheel, int64_t tick_ns, int64_t now_ns)
+{
+	memset(wheel, 0x0, sizeof(*wheel));
+	wheel->tick_ns = tick_ns;
+	wheel->origin_ns = now_ns;
+}
+
+void timer_wheel_timer_init(timer_wheel_timer_t *timer, timer_wheel_cb cb, void *user_data)
+{
+	memset(timer, 0x0, sizeof(*timer));
+	timer->cb = cb;
+	timer->user_data = user_data;
+}
+
+static void _unlink(timer_wheel_timer_t *timer)
+{
+	*timer->pprev = timer->next;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+static void _link(timer_wheel_t *wheel, timer_wheel_timer_t *timer)
+{
+	uint64_t expires = timer->expires;
+	uint64_t delta;
+	timer_wheel_timer_t **slot;
+	int level;
+
+	if (expires < wheel->current)
+		expires = wheel->current;
+	delta = expires - wheel->current;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+		if (delta < (1ULL << LEVEL_SHIFT(level + 1)))
+			break;
+	}
+
+	/* beyond range of the wheel timers wait in the last slot of the top level */
+	if (delta >= (1ULL << LEVEL_SHIFT(TIMER_WHEEL_LEVELS)))
+		expires = wheel->current + (1ULL << LEVEL_SHIFT(TIMER_WHEEL_LEVELS)) - 1;
+
+	slot = &wheel->slots[level][(expires >> LEVEL_SHIFT(level)) & SLOT_MASK];
+	timer->next = *slot;
+	if (timer->next)
+		timer->next->pprev = &timer->next;
+	timer->pprev = slot;
+	*slot = timer;
+}
+
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_timer_t *timer, int64_t deadline_ns)
+{
+	int64_t offset = deadline_ns - wheel->origin_ns;
+
+	if (timer->pprev)
+		_unlink(timer);
+	else
+		wheel->count++;
+
+	timer->expires = offset > 0 ? (offset + wheel->tick_ns - 1) / wheel->tick_ns : 0;
+	_link(wheel, timer);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_timer_t *timer)
+{
+	if (!timer->pprev)
+		return;
+
+	_unlink(timer);
+	wheel->count--;
+}
+
+/* moves timers of one slot of the level to lower levels, returns the slot index */
+static unsigned int _cascade(timer_wheel_t *wheel, int level)
+{
+	unsigned int index = (wheel->current >> LEVEL_SHIFT(level)) & SLOT_MASK;
+	timer_wheel_timer_t *timer = wheel->slots[level][index];
+	timer_wheel_timer_t *next;
+
+	wheel->slots[level][index] = NULL;
+	for (; timer; timer = next) {
+		next = timer->next;
+		_link(wheel, timer);
+	}
+
+	return index;
+}
+
+unsigned int timer_wheel_advance(timer_wheel_t *wheel, int64_t now_ns)
+{
+	timer_wheel_timer_t **slot;
+	timer_wheel_timer_t *timer;
+	unsigned int expired = 0;
+	uint64_t target;
+	int level;
+
+	if (now_ns < wheel->origin_ns)
+		return 0;
+	target = (now_ns - wheel->origin_ns) / wheel->tick_ns;
+
+	while (wheel->current <= target) {
+		/* nothing to run, skip idle period at once */
+		if (!wheel->count) {
+			wheel->current = target + 1;
+			break;
+		}
+
+		for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+			if ((wheel->current & ((1ULL << LEVEL_SHIFT(level)) - 1)) || _cascade(wheel, level))
+				break;
+		}
+
+		/* callbacks may schedule timers into the slot being processed */
+		slot = &wheel->slots[0][wheel->current & SLOT_MASK];
+		while ((timer = *slot)) {
+			_unlink(timer);
+			wheel->count--;
+			expired++;
+			timer->cb(timer, timer->user_data);
+		}
+
+		wheel->current++;
+	}
+
+	return expired;
+}
+
+int64_t timer_wheel_next_deadline(const timer_wheel_t *wheel)
+{
+	uint64_t tick;
+	uint64_t boundary = (wheel->current + SLOT_MASK) & ~(uint64_t)SLOT_MASK;
+
+	if (!wheel->count)
+		return -1;
+
+	for (tick = wheel->current; tick < boundary; tick++) {
+		if (wheel->slots[0][tick & SLOT_MASK])
+			break;
+	}
+
+	/* at the boundary higher levels are cascaded, they may hold earlier timers */
+	return wheel->origin_ns + (int64_t)tick * wheel->tick_ns;
+}
@@ -14,21 +14,54 @@
  * limitations under the License.
  */
 
+#define _GNU_SOURCE
 #include "udp_connection.h"
 #include <gio/gio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 #include "log.h"
+#include "latency.h"
+#include "messages/clock.h"
 #define MESSAGE_IN_BUF_SIZE 512
+#define MESSAGE_OUT_BUF_SIZE 512
+#define BATCH_SIZE_MAX 64
+#define SEND_QUEUE_SIZE 16
+
+typedef struct _udp_batch {
+	unsigned int size;
+	char (*buffers)[MESSAGE_IN_BUF_SIZE];
+	struct mmsghdr *headers;
+	struct iovec *iovecs;
+	struct sockaddr_in *addresses;
+} _udp_batch_s;
+
+typedef struct _udp_send_queue {
+	unsigned int count;
+	char buffers[SEND_QUEUE_SIZE][MESSAGE_OUT_BUF_SIZE];
+	struct mmsghdr headers[SEND_QUEUE_SIZE];
+	struct iovec iovecs[SEND_QUEUE_SIZE];
+	struct sockaddr_in addresses[SEND_QUEUE_SIZE];
+} _udp_send_queue_s;
 
 struct udp_connection {
 	GSocket *socket;
 	udp_receive_cb receive_cb;
+	udp_batch_end_cb batch_end_cb;
 	GIOChannel *channel;
-	guint watch_id;
+	GSource *watch;
 	GError *error;
+	_udp_batch_s batch;
+	_udp_send_queue_s queue;
+	udp_connection_stats_s stats;
 };
 
 static gboolean _channel_ready_cb(GIOChannel *source, GIOCondition cond, gpointer data);
+static gboolean _channel_ready_batch(udp_connection_t *connection);
+static void _batch_release(_udp_batch_s *batch);
+static void _batch_end(udp_connection_t *connection, unsigned int count);
 static void _connection_release_resources(udp_connection_t *connection);
 
 udp_connection_t *udp_connection_create(int port)
@@ -78,67 +111,258 @@ udp_connection_t *udp_connection_create(int port)
 
 	int socket_fd = g_socket_get_fd(connection->socket);
 	connection->channel = g_io_channel_unix_new(socket_fd);
-	connection->watch_id = g_io_add_watch(connection->channel, G_IO_IN, _channel_ready_cb, connection);
+	connection->watch = g_io_create_watch(connection->channel, G_IO_IN);
+	g_source_set_callback(connection->watch, (GSourceFunc) _channel_ready_cb, connection, NULL);
+	g_source_attach(connection->watch, g_main_context_get_thread_default());
 	g_io_channel_unref(connection->channel);
 
 	g_free(address_str);
 	return connection;
 }
 
-int udp_connection_send(udp_connection_t *connection, const char *data, unsigned short int size, const char *address, int port)
+void udp_destination_init(udp_destination_t *destination, const endpoint_t *endpoint)
+{
+	endpoint_to_sockaddr(endpoint, &destination->address);
+	destination->endpoint = *endpoint;
+}
+
+int udp_connection_send(udp_connection_t *connection, const char *data, unsigned short int size, const endpoint_t *receiver)
+{
+	udp_destination_t destination;
+
+	udp_destination_init(&destination, receiver);
+	return udp_connection_send_to(connection, data, size, &destination);
+}
+
+int udp_connection_send_to(udp_connection_t *connection, const char *data, unsigned short int size, const udp_destination_t *destination)
 {
-	GIOCondition cond = g_socket_condition_check(connection->socket, G_IO_OUT);
-	if(cond != G_IO_OUT) {
-		_E("Failed to send data - socket is not G_IO_OUT");
+	char address_str[ENDPOINT_STR_LEN];
+	ssize_t wr_size;
+
+	do {
+		wr_size = sendto(g_socket_get_fd(connection->socket), data, size, MSG_DONTWAIT,
+				(const struct sockaddr*) &destination->address, sizeof(destination->address));
+		connection->stats.send_syscalls++;
+	} while(wr_size < 0 && errno == EINTR);
+
+	if(wr_size != size) {
+		_E("Error sending data to %s: %s", endpoint_to_string(&destination->endpoint, address_str, sizeof(address_str)),
+				wr_size < 0 ? strerror(errno) : "partial write");
+		connection->stats.send_dropped++;
 		return -1;
 	}
 
-	GInetSocketAddress *receiver_address = (GInetSocketAddress*) g_inet_socket_address_new_from_string(address, port);
-	if(!receiver_address) {
-		_E("Failed to obtain socket address from %s:%d", address, port);
+	connection->stats.sent++;
+	_D("Sent %d bytes", size);
+	return 0;
+}
+
+int udp_connection_queue(udp_connection_t *connection, const char *data, unsigned short int size, const udp_destination_t *destination)
+{
+	_udp_send_queue_s *queue = &connection->queue;
+	unsigned int i;
+
+	if(size > MESSAGE_OUT_BUF_SIZE) {
+		_E("Cannot queue %d bytes (max %d)", size, MESSAGE_OUT_BUF_SIZE);
 		return -1;
 	}
 
-	GError *error = NULL;
-	gssize wr_size = g_socket_send_to(connection->socket, (GSocketAddress*) receiver_address, data, size, NULL, &error);
-	if(wr_size != size) {
-		_E("Error sending data to %s:%d - sent only %d", address, port, wr_size);
-		g_object_unref(receiver_address);
-		g_error_free(error);
-		return -1;
+	if(queue->count == SEND_QUEUE_SIZE && udp_connection_flush(connection)) {
+		_W("Send queue was full and could not be flushed");
 	}
-	g_object_unref(receiver_address);
-	_D("Sent %d bytes", size);
+
+	i = queue->count++;
+	memcpy(queue->buffers[i], data, size);
+	queue->addresses[i] = destination->address;
+	queue->iovecs[i].iov_base = queue->buffers[i];
+	queue->iovecs[i].iov_len = size;
+	queue->headers[i].msg_hdr.msg_iov = &queue->iovecs[i];
+	queue->headers[i].msg_hdr.msg_iovlen = 1;
+	queue->headers[i].msg_hdr.msg_name = &queue->addresses[i];
+	queue->headers[i].msg_hdr.msg_namelen = sizeof(queue->addresses[i]);
 	return 0;
 }
 
+int udp_connection_flush(udp_connection_t *connection)
+{
+	_udp_send_queue_s *queue = &connection->queue;
+	unsigned int sent = 0;
+	int err = 0;
+	int count;
+
+	while(sent < queue->count) {
+		count = sendmmsg(g_socket_get_fd(connection->socket), &queue->headers[sent], queue->count - sent, MSG_DONTWAIT);
+		connection->stats.send_syscalls++;
+		if(count < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				_E("Failed to send %u datagrams - socket buffer is full", queue->count - sent);
+				connection->stats.send_dropped += queue->count - sent;
+				err = -1;
+				break;
+			}
+			/* error belongs to the first datagram not sent, others may still succeed */
+			_E("Failed to send datagram: %s", strerror(errno));
+			connection->stats.send_dropped++;
+			sent++;
+			err = -1;
+			continue;
+		}
+		connection->stats.sent += count;
+		sent += count;
+	}
+
+	queue->count = 0;
+	return err;
+}
+
 void udp_connection_set_receive_cb(udp_connection_t *connection, udp_receive_cb callback)
 {
 	connection->receive_cb = callback;
 }
 
+void udp_connection_set_batch_end_cb(udp_connection_t *connection, udp_batch_end_cb callback)
+{
+	connection->batch_end_cb = callback;
+}
+
+int udp_connection_set_batch_size(udp_connection_t *connection, unsigned int batch_size)
+{
+	_udp_batch_s batch = {0, };
+	unsigned int i;
+
+	if(batch_size == 0 || batch_size > BATCH_SIZE_MAX) {
+		_E("Invalid batch size %u (max %d)", batch_size, BATCH_SIZE_MAX);
+		return -1;
+	}
+
+	_batch_release(&connection->batch);
+	if(batch_size == 1) {
+		return 0;
+	}
+
+	batch.buffers = calloc(batch_size, MESSAGE_IN_BUF_SIZE);
+	batch.headers = calloc(batch_size, sizeof(struct mmsghdr));
+	batch.iovecs = calloc(batch_size, sizeof(struct iovec));
+	batch.addresses = calloc(batch_size, sizeof(struct sockaddr_in));
+	if(!batch.buffers || !batch.headers || !batch.iovecs || !batch.addresses) {
+		_E("Failed to allocate receive batch of size %u", batch_size);
+		_batch_release(&batch);
+		return -1;
+	}
+
+	for(i = 0; i < batch_size; ++i) {
+		batch.iovecs[i].iov_base = batch.buffers[i];
+		batch.iovecs[i].iov_len = MESSAGE_IN_BUF_SIZE;
+		batch.headers[i].msg_hdr.msg_iov = &batch.iovecs[i];
+		batch.headers[i].msg_hdr.msg_iovlen = 1;
+		batch.headers[i].msg_hdr.msg_name = &batch.addresses[i];
+	}
+	batch.size = batch_size;
+
+	connection->batch = batch;
+	_D("Batched receive enabled, batch size: %u", batch_size);
+	return 0;
+}
+
+void udp_connection_get_stats(udp_connection_t *connection, udp_connection_stats_s *stats)
+{
+	*stats = connection->stats;
+}
+
 void udp_connection_destroy(udp_connection_t *connection)
 {
 	_connection_release_resources(connection);
 }
 
+static gboolean _channel_ready_batch(udp_connection_t *connection)
+{
+	_udp_batch_s *batch = &connection->batch;
+	endpoint_t sender;
+	unsigned int i;
+	unsigned int delivered = 0;
+	int64_t received_ns;
+	int count;
+
+	for(i = 0; i < batch->size; ++i) {
+		batch->headers[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		batch->headers[i].msg_hdr.msg_flags = 0;
+	}
+
+	count = recvmmsg(g_socket_get_fd(connection->socket), batch->headers, batch->size, MSG_DONTWAIT, NULL);
+	received_ns = clock_monotonic_ns_get();
+	connection->stats.syscalls++;
+	if(count < 0) {
+		if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+			return TRUE;
+		}
+		_E("Cannot read data from socket: %s", strerror(errno));
+		return FALSE;
+	}
+
+	if((unsigned int)count > connection->stats.max_batch) {
+		connection->stats.max_batch = count;
+	}
+
+	for(i = 0; i < (unsigned int)count; ++i) {
+		struct msghdr *header = &batch->headers[i].msg_hdr;
+		unsigned int size = batch->headers[i].msg_len;
+
+		if((header->msg_flags & MSG_TRUNC) || size == MESSAGE_IN_BUF_SIZE) {
+			_W("Packet dropped due to its size");
+			connection->stats.dropped++;
+			continue;
+		}
+
+		if(size == 0) {
+			_W("No data to read");
+			continue;
+		}
+
+		latency_trace_begin_at(received_ns);
+		endpoint_from_sockaddr(&sender, &batch->addresses[i]);
+		connection->stats.datagrams++;
+		delivered++;
+		if(connection->receive_cb) {
+			connection->receive_cb(batch->buffers[i], size, &sender);
+		}
+	}
+
+	if(delivered) {
+		_batch_end(connection, delivered);
+	}
+
+	return TRUE;
+}
+
 static gboolean _channel_ready_cb(GIOChannel *source, GIOCondition cond, gpointer data)
 {
 	udp_connection_t *connection = (udp_connection_t*) data;
-	GError *error = NULL;
-	GInetSocketAddress *socket_address = NULL;
+	struct sockaddr_in native;
+	socklen_t native_len = sizeof(native);
+	endpoint_t sender;
 	gchar buffer[MESSAGE_IN_BUF_SIZE];
 
-	gssize size = g_socket_receive_from(connection->socket, (GSocketAddress**) &socket_address, buffer, MESSAGE_IN_BUF_SIZE, NULL, &error);
+	connection->stats.wakeups++;
+	if(connection->batch.size > 1) {
+		return _channel_ready_batch(connection);
+	}
+
+	gssize size = recvfrom(g_socket_get_fd(connection->socket), buffer, MESSAGE_IN_BUF_SIZE, MSG_DONTWAIT, (struct sockaddr*) &native, &native_len);
+	connection->stats.syscalls++;
 	if(size < 0) {
-		_E("Cannot read data from socket");
-		g_error_free(error);
+		if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+			return TRUE;
+		}
+		_E("Cannot read data from socket: %s", strerror(errno));
 		return FALSE;
 	}
 
 	if(size == MESSAGE_IN_BUF_SIZE) {
 		_W("Packet dropped due to its size");
-		g_error_free(error);
+		connection->stats.dropped++;
 		return TRUE;
 	}
 
@@ -147,36 +371,61 @@ static gboolean _channel_ready_cb(GIOChannel *source, GIOCondition cond, gpointe
 		return TRUE;
 	}
 
-	GInetAddress *address= g_inet_socket_address_get_address(socket_address);
-	if(!address) {
-		_E("Failed to obtain the address of received message");
-		return TRUE;
-	}
-
-	gchar *address_str = g_inet_address_to_string(address);
-	if(!address_str) {
-		_E("Failed to obtain the address in text of received message");
-		g_object_unref(address);
-		return TRUE;
+	latency_trace_begin();
+	endpoint_from_sockaddr(&sender, &native);
+	connection->stats.datagrams++;
+	if(!connection->stats.max_batch) {
+		connection->stats.max_batch = 1;
 	}
-
-	int port = g_inet_socket_address_get_port(socket_address);
 	if(connection->receive_cb) {
-		connection->receive_cb(buffer, size, address_str, port);
+		connection->receive_cb(buffer, size, &sender);
 	}
-
-	g_free(address_str);
-	g_object_unref(socket_address);
+	_batch_end(connection, 1);
 
 	return TRUE;
 }
 
+static void _batch_end(udp_connection_t *connection, unsigned int count)
+{
+	if(connection->batch_end_cb) {
+		connection->batch_end_cb(count);
+	}
+	if(connection->queue.count) {
+		udp_connection_flush(connection);
+	}
+}
+
+static void _batch_release(_udp_batch_s *batch)
+{
+	free(batch->buffers);
+	free(batch->headers);
+	free(batch->iovecs);
+	free(batch->addresses);
+	memset(batch, 0x0, sizeof(_udp_batch_s));
+}
+
 static void _connection_release_resources(udp_connection_t *connection)
 {
 	if(!connection) {
 		return;
 	}
 
+	if(connection->socket && connection->queue.count) {
+		udp_connection_flush(connection);
+	}
+
+	_I("Received %llu datagrams in %llu wakeups using %llu syscalls (max batch %u, dropped %llu)",
+			connection->stats.datagrams, connection->stats.wakeups, connection->stats.syscalls,
+			connection->stats.max_batch, connection->stats.dropped);
+	_I("Sent %llu datagrams using %llu syscalls (dropped %llu)",
+			connection->stats.sent, connection->stats.send_syscalls, connection->stats.send_dropped);
+	_batch_release(&connection->batch);
+
+	if(connection->watch) {
+		g_source_destroy(connection->watch);
+		g_source_unref(connection->watch);
+	}
+
 	if(connection->error) {
 		g_error_free(connection->error);
 	}